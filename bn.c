@@ -1,1097 +1,5713 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+/*  Vector kernels for the linear limb operations, chosen at run time by 
+ *  the features of the CPU. Building with BN_NO_SIMD keeps only the 
+ *  scalar loops.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(BN_NO_SIMD)
+#define BN_SIMD
+#include <immintrin.h>
+#endif
 
 #include "bn.h"
 
+typedef unsigned __int128 uint128_t;
+
+/*  Largest power of ten that fits in a limb, used to move between the
+ *  binary representation and decimal text nineteen digits at a time
+ */
+#define DEC_CHUNK_DIGITS 19
+#define DEC_CHUNK_BASE   10000000000000000000ULL
+
+/*  Version of the binary container written by serialize_bn
+ */
+#define BN_FORMAT_VERSION 1
+
+/*  ASCII digit pairs 00 to 99, so that a chunk is rendered two digits 
+ *  per division
+ */
+static const char dec_pairs[201] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/*  Size in limbs from which decimal conversion splits the number by 
+ *  powers 10^(19 2^k) instead of running the quadratic chunk loop, so that 
+ *  both directions ride on the subquadratic multiplication and division
+ */
+#ifndef DEC_DC_THRESHOLD
+#define DEC_DC_THRESHOLD 40
+#endif
+
+/*  Operand size in limbs from which multiplication switches from the 
+ *  schoolbook method to Karatsuba. Both cost about the same between 32 
+ *  and 48 limbs on x86-64, it can be tuned at compile time.
+ */
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 32
+#endif
+
+/*  Same crossover for squaring, which is reached later because the 
+ *  schoolbook square computes each cross product only once
+ */
+#ifndef SQR_KARATSUBA_THRESHOLD
+#define SQR_KARATSUBA_THRESHOLD 48
+#endif
+
+/*  Operand sizes in limbs from which the Toom-Cook 3-way and 4-way 
+ *  multiplications take over from Karatsuba and Toom-3 respectively. On 
+ *  x86-64 Toom-3 breaks even with Karatsuba from 250 to 400 limbs and is 
+ *  9% faster at 500 limbs (78 vs 85 us), 10% at 1200 and 20% at 1600. 
+ *  Toom-4 from 1000 limbs matches or beats Toom-3 up to 3000 limbs.
+ */
+#ifndef TOOM3_THRESHOLD
+#define TOOM3_THRESHOLD 400
+#endif
+
+#ifndef TOOM4_THRESHOLD
+#define TOOM4_THRESHOLD 1000
+#endif
+
+/*  Operand size in limbs from which the number theoretic transform 
+ *  replaces Toom-Cook multiplication, about 5000 limbs (96k decimal 
+ *  digits) on x86-64. Below it the transform loses by up to 50% and 
+ *  around 3000-4500 limbs the result depends on how well the product 
+ *  fills the transform; from 5500 limbs it wins by 15-30%.
+ */
+#ifndef NTT_THRESHOLD
+#define NTT_THRESHOLD 5000
+#endif
+
+/*  Same crossovers for squaring, which are reached later because 
+ *  Karatsuba squaring saves more than the Toom-Cook squares and the 
+ *  transform, which only skips one of its three transforms. Toom-3 
+ *  squaring gains nothing before Toom-4 squaring overtakes Karatsuba 
+ *  around 1000 limbs, so both start there. The transform squares faster 
+ *  from about 9000 limbs on x86-64: 4148 vs 4963 us at 9000 limbs, but 
+ *  596 vs 345 us at 1600 and 3863 vs 3367 us at 7000.
+ */
+#ifndef SQR_TOOM3_THRESHOLD
+#define SQR_TOOM3_THRESHOLD 1000
+#endif
+
+#ifndef SQR_TOOM4_THRESHOLD
+#define SQR_TOOM4_THRESHOLD 1000
+#endif
+
+#ifndef SQR_NTT_THRESHOLD
+#define SQR_NTT_THRESHOLD 9000
+#endif
+
+/*  Divisor and quotient size in limbs from which division switches from 
+ *  Algorithm D to the recursive Burnikel-Ziegler method. Anything from 30 
+ *  to 100 limbs costs about the same on x86-64.
+ */
+#ifndef DC_DIV_THRESHOLD
+#define DC_DIV_THRESHOLD 40
+#endif
+
+/*  Modulus size in limbs below which Barrett reduction computes only the 
+ *  needed halves of its two products with the schoolbook method, which 
+ *  beats full Karatsuba products up to about 100 limbs on x86-64
+ */
+#ifndef BARRETT_THRESHOLD
+#define BARRETT_THRESHOLD 100
+#endif
+
+/*  Operand size in limbs from which the greatest common divisor switches 
+ *  from the binary method to Lehmer's, which batches the Euclidean steps 
+ *  through the leading bits of the operands. The binary method only wins 
+ *  on one and two limbs on x86-64.
+ */
+#ifndef GCD_LEHMER_THRESHOLD
+#define GCD_LEHMER_THRESHOLD 3
+#endif
+
+/*  Size in limbs from which addition, subtraction and comparison run on 
+ *  the AVX2 or AVX-512 kernels. Below 16 limbs the lane masks cost more 
+ *  than the scalar carry chain on x86-64.
+ */
+#ifndef SIMD_THRESHOLD
+#define SIMD_THRESHOLD 16
+#endif
+
+/*  Primes c * 2^40 + 1 below 2^63 used by the number theoretic transform 
+ *  and a primitive root of each. Their product exceeds 2^188, so the 
+ *  convolution of up to 2^40 limbs is recovered exactly by the CRT.
+ */
+static const uint64_t ntt_primes[3] = {0x7ffffe0000000001ULL, 0x7fffef0000000001ULL, 0x7fffe90000000001ULL};
+static const uint64_t ntt_generators[3] = {7, 5, 7};
+
+/*  Read-only constants shared by the operations instead of being created 
+ *  on every call
+ */
+static BIGNUM one_bn = { .digits = (uint64_t[]){1},  .sign = 1, .size = 1, .capacity = 1 };
+static BIGNUM ten_bn = { .digits = (uint64_t[]){10}, .sign = 1, .size = 1, .capacity = 1 };
+
+/*  Context bound to the calling thread by set_ctx_bn. When none is bound 
+ *  the operations use a default context of the thread, created on first 
+ *  use and kept warm until the thread exits, when the destructor of 
+ *  default_ctx_key frees it. If the key cannot hold it, a transient 
+ *  context lives for the duration of the outermost operation instead.
+ */
+static _Thread_local BN_CTX *thread_ctx = NULL;
+static _Thread_local BN_CTX *default_ctx = NULL;
+static _Thread_local BN_CTX *transient_ctx = NULL;
+
+static pthread_key_t default_ctx_key;
+static pthread_once_t default_ctx_once = PTHREAD_ONCE_INIT;
+static uint8_t default_ctx_key_ready = 0;
+
+/*  Powers 10^(19 2^k) of the decimal conversions, each in a Barrett 
+ *  context whose reciprocal is filled when a division first needs it. 
+ *  They are kept per thread and extended as larger numbers are 
+ *  converted, freed like the default context by the destructor of 
+ *  dec_powers_key, or after the conversion if the key cannot hold them.
+ */
+typedef struct {
+	BN_BARRETT *pw[32];
+	int count;
+} BN_DEC_POWERS;
+
+static _Thread_local BN_DEC_POWERS *dec_powers = NULL;
+
+static pthread_key_t dec_powers_key;
+static pthread_once_t dec_powers_once = PTHREAD_ONCE_INIT;
+static uint8_t dec_powers_key_ready = 0;
 
-/*	Initializes the number values ​​and returns a big number pointer	
+#ifdef BN_SIMD
+/*  Widest vector unit the CPU supports, queried through the CPU model 
+ *  libgcc fills in at startup so one binary runs everywhere
  *
- *  Input:
- *  Output: a big number pointer
+ *  Input: 
+ *  Output: 
+ *			2 - if AVX-512 is available
+ *			1 - if only AVX2 is available
+ *			0 - otherwise
  * 
  */
-BIGNUM* init_bn(){
-	
-	BIGNUM *num = malloc(sizeof(BIGNUM));
-	num->digits = NULL;
-	num->size   = 0;
-	num->sign   = 1;
+static int simd_level(void){
+	if(__builtin_cpu_supports("avx512f")){
+		return 2;
+	}
 
-	return num;
+	return __builtin_cpu_supports("avx2") ? 1 : 0;
+}
+
+/*  Adds two limb arrays eight lanes at a time. Each lane sum is 
+ *  computed without carries, then the carry into every lane comes from 
+ *  carry lookahead on the lane masks: generate marks the lanes that 
+ *  wrapped and propagate the lanes that are all ones, so adding the 
+ *  shifted generate mask to the propagate mask ripples the carries 
+ *  through the block in a single integer addition.
+ *
+ *  Input: result array, two limb arrays, their size, a multiple of 8
+ *  Output: the carry out of the most significant limb
+ * 
+ */
+__attribute__((target("avx512f")))
+static uint64_t add_n_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, int n){
+	const __m512i one = _mm512_set1_epi64(1), max = _mm512_set1_epi64(-1);
+	uint32_t carry = 0;
+
+	for(int i = 0; i < n; i += 8){
+		__m512i x = _mm512_loadu_si512(a + i);
+		__m512i s = _mm512_add_epi64(x, _mm512_loadu_si512(b + i));
+
+		uint32_t g   = _mm512_cmplt_epu64_mask(s, x);
+		uint32_t p   = _mm512_cmpeq_epi64_mask(s, max);
+		uint32_t inc = (((g << 1) | carry) + p) ^ p;
+
+		s = _mm512_mask_add_epi64(s, (__mmask8)inc, s, one);
+		_mm512_storeu_si512(r + i, s);
+		carry = inc >> 8;
+	}
 
+	return carry;
 }
 
-/*	Converts a big number to an integer	
+/*  Subtracts two limb arrays eight lanes at a time, with the borrows 
+ *  resolved by the same lookahead as add_n_avx512: generate marks the 
+ *  lanes that wrapped and propagate the lanes that are zero
  *
- *  Input: a big number pointer
- *  Output: an integer
+ *  Input: result array, minuend and subtrahend limb arrays, their size, 
+ *         a multiple of 8
+ *  Output: the borrow out of the most significant limb
  * 
  */
-int bn_to_int(BIGNUM *nnum){
-	
-	int result = 0;
-	
-	BIGNUM *num = init_bn();
-	copy_bn(num, nnum);
-	
-	rev_bn(num);
-	for(int i = 0, e = 1; i < num->size; i++, e*=10){
-		result += num->digits[i] * e;
+__attribute__((target("avx512f")))
+static uint64_t sub_n_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, int n){
+	const __m512i one = _mm512_set1_epi64(1);
+	uint32_t borrow = 0;
+
+	for(int i = 0; i < n; i += 8){
+		__m512i x = _mm512_loadu_si512(a + i);
+		__m512i y = _mm512_loadu_si512(b + i);
+		__m512i d = _mm512_sub_epi64(x, y);
+
+		uint32_t g   = _mm512_cmplt_epu64_mask(x, y);
+		uint32_t p   = _mm512_cmpeq_epi64_mask(d, _mm512_setzero_si512());
+		uint32_t dec = (((g << 1) | borrow) + p) ^ p;
+
+		d = _mm512_mask_sub_epi64(d, (__mmask8)dec, d, one);
+		_mm512_storeu_si512(r + i, d);
+		borrow = dec >> 8;
 	}
-	
-	if(num->sign == 0){
-		result *= -1;
+
+	return borrow;
+}
+
+/*  Expands the low four bits of a mask to AVX2 lanes of all ones
+ *
+ *  Input: bit mask, one bit per lane
+ *  Output: vector with lane i all ones where bit i is set, zero elsewhere
+ * 
+ */
+__attribute__((target("avx2")))
+static inline __m256i lanes_avx2(uint32_t mask){
+	const __m256i bits = _mm256_setr_epi64x(1, 2, 4, 8);
+
+	return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(mask), bits), bits);
+}
+
+/*  Adds two limb arrays four lanes at a time with the lookahead of 
+ *  add_n_avx512. AVX2 has no unsigned compare, so the wrapped lanes are 
+ *  found by a signed compare with the sign bits flipped.
+ *
+ *  Input: result array, two limb arrays, their size, a multiple of 4
+ *  Output: the carry out of the most significant limb
+ * 
+ */
+__attribute__((target("avx2")))
+static uint64_t add_n_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, int n){
+	const __m256i bias = _mm256_set1_epi64x(INT64_MIN), max = _mm256_set1_epi64x(-1);
+	uint32_t carry = 0;
+
+	for(int i = 0; i < n; i += 4){
+		__m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+		__m256i s = _mm256_add_epi64(x, _mm256_loadu_si256((const __m256i*)(b + i)));
+
+		__m256i wrap = _mm256_cmpgt_epi64(_mm256_xor_si256(x, bias), _mm256_xor_si256(s, bias));
+		uint32_t g   = _mm256_movemask_pd(_mm256_castsi256_pd(wrap));
+		uint32_t p   = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(s, max)));
+		uint32_t inc = (((g << 1) | carry) + p) ^ p;
+
+		s = _mm256_sub_epi64(s, lanes_avx2(inc));
+		_mm256_storeu_si256((__m256i*)(r + i), s);
+		carry = inc >> 4;
 	}
 
-	return result;
+	return carry;
 }
 
-/*	Converts an integer to a big number
+/*  Subtracts two limb arrays four lanes at a time with the lookahead of 
+ *  sub_n_avx512
  *
- *  Input: an integer
- *  Output: a big number pointer
+ *  Input: result array, minuend and subtrahend limb arrays, their size, 
+ *         a multiple of 4
+ *  Output: the borrow out of the most significant limb
  * 
  */
-BIGNUM* int_to_bn(int num){
-	
-	BIGNUM *bignum = init_bn();
-	
-	if(num < 0){
-		bignum->sign = 0;
-		num *= -1;
+__attribute__((target("avx2")))
+static uint64_t sub_n_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, int n){
+	const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+	uint32_t borrow = 0;
+
+	for(int i = 0; i < n; i += 4){
+		__m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+		__m256i y = _mm256_loadu_si256((const __m256i*)(b + i));
+		__m256i d = _mm256_sub_epi64(x, y);
+
+		__m256i wrap = _mm256_cmpgt_epi64(_mm256_xor_si256(y, bias), _mm256_xor_si256(x, bias));
+		uint32_t g   = _mm256_movemask_pd(_mm256_castsi256_pd(wrap));
+		uint32_t p   = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(d, _mm256_setzero_si256())));
+		uint32_t dec = (((g << 1) | borrow) + p) ^ p;
+
+		d = _mm256_add_epi64(d, lanes_avx2(dec));
+		_mm256_storeu_si256((__m256i*)(r + i), d);
+		borrow = dec >> 4;
+	}
 
-	}else {
-		bignum->sign = 1;
+	return borrow;
+}
+
+/*  Skips the equal most significant limbs of two arrays four at a time
+ *
+ *  Input: two limb arrays and their size
+ *  Output: size of the arrays once the equal top blocks are dropped, the 
+ *          highest differing limb, if any, lies below it
+ * 
+ */
+__attribute__((target("avx2")))
+static int equal_top_avx2(const uint64_t *a, const uint64_t *b, int n){
+	while(n >= 4){
+		__m256i x = _mm256_loadu_si256((const __m256i*)(a + n - 4));
+		__m256i y = _mm256_loadu_si256((const __m256i*)(b + n - 4));
+
+		if(!_mm256_testc_si256(_mm256_cmpeq_epi64(x, y), _mm256_set1_epi64x(-1))){
+			break;
+		}
 
+		n -= 4;
 	}
-	
-	do{
-		bignum->digits = realloc(bignum->digits, ++bignum->size);
-		bignum->digits[bignum->size - 1] = num % 10;
-		num /= 10;
-	
-	}while(num != 0);
 
-	rev_bn(bignum);
-	return bignum;
-	
+	return n;
 }
+#endif
 
-BIGNUM* str_to_bn(char num[], int size){
-	BIGNUM *bignum = init_bn();
-	
-	if(num[0] == '-'){
-		bignum->digits = malloc(size-1);
-		bignum->sign   = 0;
-		bignum->size   = size - 1;
+/*  Compares two normalized limb arrays
+ *
+ *  Input: first limb array and its size, second limb array and its size
+ *  Output:
+ *			1 - if the first array is greater than the second
+ *    		0 - if the two arrays are equal
+ *   	   -1 - if the first array is less than the second
+ * 
+ */
+static int comp_limbs(const uint64_t *a, int an, const uint64_t *b, int bn){
+	if(an != bn){
+		return an > bn ? 1 : -1;
+	}
+
+#ifdef BN_SIMD
+	if(an >= SIMD_THRESHOLD && a[an - 1] == b[an - 1] && simd_level() > 0){
+		an = equal_top_avx2(a, b, an);
+	}
+#endif
 
-		for (int i = 1; i < size; i++){
-			bignum->digits[i-1] = num[i] - 48;
+	for(int i = an - 1; i >= 0; i--){
+		if(a[i] != b[i]){
+			return a[i] > b[i] ? 1 : -1;
 		}
-	}else {
-		bignum->digits = malloc(size);
-		bignum->size   = size;
+	}
+
+	return 0;
+}
 
-		for (int i = 0; i < size; i++){
-			bignum->digits[i] = num[i] - 48;
+/*  Adds two limb arrays, an >= bn, writing an limbs to r
+ *
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size
+ *  Output: the carry out of the most significant limb
+ * 
+ */
+static uint64_t add_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	uint64_t carry = 0;
+	int i = 0;
+
+#ifdef BN_SIMD
+	if(bn >= SIMD_THRESHOLD){
+		int level = simd_level();
+
+		if(level == 2){
+			i     = bn & ~7;
+			carry = add_n_avx512(r, a, b, i);
+		}else if(level == 1){
+			i     = bn & ~3;
+			carry = add_n_avx2(r, a, b, i);
 		}
 	}
+#endif
 
-	return bignum;
+	for(; i < bn; i++){
+		uint128_t s = (uint128_t)a[i] + b[i] + carry;
+		r[i]  = (uint64_t)s;
+		carry = (uint64_t)(s >> 64);
+	}
+
+	for(; i < an; i++){
+		r[i]  = a[i] + carry;
+		carry = r[i] < carry;
+	}
+
+	return carry;
 }
 
-/*	Calculates the bit size of a large number
+/*  Subtracts two limb arrays, a >= b and an >= bn, writing an limbs to r
  *
- *  Input: a big number
- *  Output: an integer containing the length in bits
+ *  Input: result array, minuend limb array and its size, subtrahend
+ *         limb array and its size
+ *  Output: the borrow out of the most significant limb
  * 
  */
-int bit_length_bn(BIGNUM *xx){
+static uint64_t sub_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	uint64_t borrow = 0;
+	int i = 0;
+
+#ifdef BN_SIMD
+	if(bn >= SIMD_THRESHOLD){
+		int level = simd_level();
+
+		if(level == 2){
+			i      = bn & ~7;
+			borrow = sub_n_avx512(r, a, b, i);
+		}else if(level == 1){
+			i      = bn & ~3;
+			borrow = sub_n_avx2(r, a, b, i);
+		}
+	}
+#endif
+
+	for(; i < bn; i++){
+		uint64_t d = a[i] - b[i];
+		uint64_t o = a[i] < b[i];
+		r[i]   = d - borrow;
+		borrow = o | (d < borrow);
+	}
+
+	for(; i < an; i++){
+		uint64_t d = a[i];
+		r[i]   = d - borrow;
+		borrow = d < borrow;
+	}
+
+	return borrow;
+}
+
+/*  Multiplies a limb array by a single limb and adds the product to r
+ *
+ *  Input: result array, limb array, its size, single limb multiplier
+ *  Output: the carry out of the most significant limb
+ * 
+ */
+static uint64_t addmul_1_limbs(uint64_t *r, const uint64_t *a, int n, uint64_t b){
+	uint64_t carry = 0;
 
-	int result = 0;
+	for(int i = 0; i < n; i++){
+		uint128_t p = (uint128_t)a[i] * b + r[i] + carry;
+		r[i]  = (uint64_t)p;
+		carry = (uint64_t)(p >> 64);
+	}
+
+	return carry;
+}
 
-	BIGNUM *zero = int_to_bn(0);
-	BIGNUM *two  = int_to_bn(2);
+/*  Multiplies a limb array by a single limb and subtracts the product 
+ *  from r
+ *
+ *  Input: result array, limb array, its size, single limb multiplier
+ *  Output: the borrow out of the most significant limb
+ * 
+ */
+static uint64_t submul_1_limbs(uint64_t *r, const uint64_t *a, int n, uint64_t b){
+	uint64_t borrow = 0;
+
+	for(int i = 0; i < n; i++){
+		uint128_t p = (uint128_t)a[i] * b + borrow;
+		uint64_t lo = (uint64_t)p;
+		uint64_t t  = r[i];
+		r[i]   = t - lo;
+		borrow = (uint64_t)(p >> 64) + (t < lo);
+	}
 
-	BIGNUM *x = init_bn();
-	copy_bn(x , xx);
+	return borrow;
+}
 
-	while(comp_bn(x, zero) != 0){
-		BIGNUM *div = init_bn();
-		div_bn(x, two, div);
+/*  Shifts a limb array left by less than a limb, r may alias a
+ *
+ *  Input: result array, limb array, its size, shift in bits
+ *  Output: the bits shifted out of the most significant limb
+ * 
+ */
+static uint64_t lshift_limbs(uint64_t *r, const uint64_t *a, int n, int shift){
+	if(shift == 0){
+		memmove(r, a, n * sizeof(uint64_t));
+		return 0;
+	}
 
-		result++;
-		copy_bn(x, div);
+	uint64_t out = a[n - 1] >> (64 - shift);
 
-		free_bn(div);
+	for(int i = n - 1; i > 0; i--){
+		r[i] = (a[i] << shift) | (a[i - 1] >> (64 - shift));
 	}
+	r[0] = a[0] << shift;
 
-	return result;
+	return out;
 }
 
-/*	Copy a big number to another big number
+/*  Shifts a limb array right by less than a limb, r may alias a
  *
- *  Input: two big numbers pointer
+ *  Input: result array, limb array, its size, shift in bits
  *  Output:
  * 
  */
-void copy_bn(BIGNUM *a, BIGNUM *b){
-	a->size = b->size;
-	a->sign = b->sign;
-	
-	free(a->digits);
-	a->digits = malloc(a->size);
-	for(int i = 0; i < a->size; i++){
-		a->digits[i] = b->digits[i];
+static void rshift_limbs(uint64_t *r, const uint64_t *a, int n, int shift){
+	if(shift == 0){
+		memmove(r, a, n * sizeof(uint64_t));
+		return;
 	}
+
+	for(int i = 0; i < n - 1; i++){
+		r[i] = (a[i] >> shift) | (a[i + 1] << (64 - shift));
+	}
+	r[n - 1] = a[n - 1] >> shift;
 }
 
-/*	Copy a big number to another big number and 
- *	invert the order of the digits 
+/*  Multiplies a limb array by a single limb, r may alias a
  *
- *  Input: two big numbers pointer
+ *  Input: result array, limb array, its size, single limb multiplier
+ *  Output: the carry out of the most significant limb
+ * 
+ */
+static uint64_t mul_1_limbs(uint64_t *r, const uint64_t *a, int n, uint64_t b){
+	uint64_t carry = 0;
+
+	for(int i = 0; i < n; i++){
+		uint128_t p = (uint128_t)a[i] * b + carry;
+		r[i]  = (uint64_t)p;
+		carry = (uint64_t)(p >> 64);
+	}
+
+	return carry;
+}
+
+/*  Divides a limb array by a single limb known to divide it exactly, 
+ *  multiplying by the inverse of the odd part of the divisor modulo 2^64 
+ *  instead of dividing. q may alias a.
+ *
+ *  Input: quotient array, dividend limb array, its size, single limb divisor
  *  Output:
  * 
  */
-void copy_rev_bn(BIGNUM *a, BIGNUM *b){
-	a->size = b->size;
-	a->sign = b->sign;
-	
-	free(a->digits);
-	a->digits = malloc(a->size);
-	for(int i = a->size - 1, j = 0; i >= 0; i--, j++){
-		a->digits[j] = b->digits[i];
+static void divexact_1_limbs(uint64_t *q, const uint64_t *a, int n, uint64_t d){
+	int shift = __builtin_ctzll(d);
+	d >>= shift;
+
+	/* d * d = 1 mod 8, each Newton step doubles the correct bits */
+	uint64_t inv = d;
+	for(int i = 0; i < 5; i++){
+		inv *= 2 - d * inv;
+	}
+
+	uint64_t borrow = 0;
+
+	for(int i = 0; i < n; i++){
+		uint64_t s = a[i] >> shift;
+
+		if(shift && i + 1 < n){
+			s |= a[i + 1] << (64 - shift);
+		}
+
+		uint64_t x  = s - borrow;
+		uint64_t qi = x * inv;
+
+		borrow = (uint64_t)(((uint128_t)qi * d) >> 64) + (s < borrow);
+		q[i]   = qi;
 	}
 }
 
-/*	Reverse the order of the digits of the large number
+/*  Compares two limb arrays of the same size, leading zeros allowed
  *
- *  Input: a big number pointer
+ *  Input: first limb array, second limb array, their size
+ *  Output: 1, 0 or -1 as comp_limbs
+ * 
+ */
+static int comp_n_limbs(const uint64_t *a, const uint64_t *b, int n){
+	for(int i = n - 1; i >= 0; i--){
+		if(a[i] != b[i]){
+			return a[i] > b[i] ? 1 : -1;
+		}
+	}
+
+	return 0;
+}
+
+/*  Computes the absolute difference of two limb arrays, an >= bn, 
+ *  leading zeros allowed, writing an limbs to r
+ *
+ *  Input: result array, first limb array and its size, second limb 
+ *         array and its size
+ *  Output: 1 if the first array is less than the second, 0 otherwise
+ * 
+ */
+static int abs_sub_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	for(int i = an - 1; i >= bn; i--){
+		if(a[i] != 0){
+			sub_limbs(r, a, an, b, bn);
+			return 0;
+		}
+	}
+
+	if(comp_n_limbs(a, b, bn) >= 0){
+		sub_limbs(r, a, an, b, bn);
+		return 0;
+	}
+
+	sub_limbs(r, b, bn, a, bn);
+	memset(r + bn, 0, (an - bn) * sizeof(uint64_t));
+
+	return 1;
+}
+
+/*  Multiplies two limb arrays with the schoolbook method, r must not
+ *  overlap the operands and must hold an + bn limbs
+ *
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size
  *  Output:
  * 
  */
-void rev_bn(BIGNUM *num){
-	for(int i = 0, j = num->size - 1; i < num->size/2-0.5; i++, j--){
-		int aux = num->digits[i];
-		num->digits[i] = num->digits[j];
-		num->digits[j] = aux;
+static void mul_basecase_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	memset(r, 0, (an + bn) * sizeof(uint64_t));
+
+	for(int i = 0; i < bn; i++){
+		r[i + an] = addmul_1_limbs(r + i, a, an, b[i]);
 	}
 }
 
-/*	Removes zeros to the left of the large number
+/*  Computes the low n limbs of the product of two limb arrays with the 
+ *  schoolbook method, skipping the partial products above them. r must 
+ *  not overlap the operands and must hold n limbs.
  *
- *  Input: a big number pointer
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size, number of limbs wanted
  *  Output:
  * 
  */
-void rmzero_bn(BIGNUM *num){
-	while(num->digits[0] == 0 && num->size > 1){
-		for(int i = 0; i < num->size - 1; i++){
-			num->digits[i] = num->digits[i+1];
+static void mullo_basecase_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn, int n){
+	memset(r, 0, n * sizeof(uint64_t));
+
+	for(int i = 0; i < bn && i < n; i++){
+		int len = an < n - i ? an : n - i;
+		uint64_t carry = addmul_1_limbs(r + i, a, len, b[i]);
+
+		if(i + len < n){
+			r[i + len] = carry;
 		}
+	}
+}
+
+/*  Computes the product of two limb arrays with the schoolbook method 
+ *  except for the partial products a[j] * b[i] with i + j < s, so that 
+ *  the limbs from s + 2 up are at most one below the exact ones, as long 
+ *  as s is below 2^64. The limbs below s are left undefined. r must not 
+ *  overlap the operands and must hold an + bn limbs.
+ *
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size, first limb position that is kept
+ *  Output:
+ * 
+ */
+static void mulhi_basecase_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn, int s){
+	memset(r, 0, (an + bn) * sizeof(uint64_t));
+
+	for(int i = 0; i < bn; i++){
+		int j = s - i < 0 ? 0 : s - i;
 
-		num->digits = realloc(num->digits, --num->size);
+		if(j < an){
+			r[i + an] = addmul_1_limbs(r + i + j, a + j, an - j, b[i]);
+		}
 	}
 }
 
-/*  Compares two large numbers
+/*  Squares a limb array with the schoolbook method, computing each cross 
+ *  product a[i] * a[j], i < j, once, doubling their sum and adding the 
+ *  squares of the limbs. r must not overlap a and must hold 2n limbs.
  *
- *  Input: two big numbers pointer
+ *  Input: result array, limb array and its size
  *  Output:
- *			1 - if the first number is greater than the second
- *    		0 - if the two numbers are equal
- *   	   -1 - if the first number is less than the second
  * 
  */
-int comp_bn(BIGNUM *num1, BIGNUM *num2){
-	if(num1->size > num2->size){
-		return 1;
-	}else if(num2->size > num1->size){
-		return -1;
-	}else {
+static void sqr_basecase_limbs(uint64_t *r, const uint64_t *a, int n){
+	memset(r, 0, 2 * n * sizeof(uint64_t));
 
-		for(int i = 0; i < num1->size; i++){
-			if(num1->digits[i] > num2->digits[i]){
-				return 1;
-				break;
-		
-			}else if(num1->digits[i] < num2->digits[i]){
-				return -1;
-				break;
-			}
-		}	
+	for(int i = 0; i < n - 1; i++){
+		r[n + i] = addmul_1_limbs(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+	}
+
+	uint64_t bit = 0;
+
+	for(int i = 0; i < 2 * n; i++){
+		uint64_t top = r[i] >> 63;
+		r[i] = (r[i] << 1) | bit;
+		bit = top;
+	}
+
+	uint64_t carry = 0;
+
+	for(int i = 0; i < n; i++){
+		uint128_t sq = (uint128_t)a[i] * a[i];
+		uint128_t lo = (uint128_t)r[2 * i] + (uint64_t)sq + carry;
+		uint128_t hi = (uint128_t)r[2 * i + 1] + (uint64_t)(sq >> 64) + (uint64_t)(lo >> 64);
 
-		return 0;	
+		r[2 * i] = (uint64_t)lo;
+		r[2 * i + 1] = (uint64_t)hi;
+		carry = (uint64_t)(hi >> 64);
 	}
 }
 
-/*	Returns the highest value
+/*  Computes the reciprocal floor((2^128 - 1) / d) - 2^64 of a limb with 
+ *  its most significant bit set, used to replace hardware divisions by 
+ *  multiplications (Moller and Granlund, "Improved division by invariant 
+ *  integers")
  *
- *  Input: two integers
- *  Output: the largest among the integers
+ *  Input: a normalized limb
+ *  Output: the reciprocal
  * 
  */
-int max(int x, int y){
-	if(x >= y){
-		return x;
+static uint64_t reciprocal_word(uint64_t d){
+	return (uint64_t)((((uint128_t)~d << 64) | ~(uint64_t)0) / d);
+}
+
+/*  Divides a two limb number by a normalized limb using its reciprocal, 
+ *  the high limb must be less than the divisor
+ *
+ *  Input: pointer to receive the remainder, high limb, low limb, 
+ *         normalized divisor, its reciprocal
+ *  Output: the quotient
+ * 
+ */
+static inline uint64_t div_2by1_limbs(uint64_t *rem, uint64_t u1, uint64_t u0, uint64_t d, uint64_t v){
+	uint128_t q = (uint128_t)v * u1 + (((uint128_t)u1 << 64) | u0);
+	uint64_t q1 = (uint64_t)(q >> 64) + 1;
+	uint64_t q0 = (uint64_t)q;
+	uint64_t r  = u0 - q1 * d;
+
+	if(r > q0){
+		q1--;
+		r += d;
+	}
+	if(r >= d){
+		q1++;
+		r -= d;
 	}
 
-	return y;
+	*rem = r;
+	return q1;
 }
 
-/*  Free a big number of memory
+/*  Divides a limb array by a single limb, q may alias a or be NULL when
+ *  only the remainder is needed
  *
- *  Input: a big number pointer
+ *  Input: quotient array, dividend limb array, its size, single limb divisor
+ *  Output: the remainder
+ * 
+ */
+static uint64_t divmod_1_limbs(uint64_t *q, const uint64_t *a, int n, uint64_t d){
+	int shift = __builtin_clzll(d);
+	uint64_t dn  = d << shift;
+	uint64_t v   = reciprocal_word(dn);
+	uint64_t rem = 0;
+
+	/* divides a * 2^shift by d * 2^shift, which has the same quotient */
+	if(shift && n > 0){
+		rem = a[n - 1] >> (64 - shift);
+	}
+
+	for(int i = n - 1; i >= 0; i--){
+		uint64_t u0 = a[i] << shift;
+
+		if(shift && i > 0){
+			u0 |= a[i - 1] >> (64 - shift);
+		}
+
+		uint64_t qi = div_2by1_limbs(&rem, rem, u0, dn, v);
+
+		if(q != NULL){
+			q[i] = qi;
+		}
+	}
+
+	return rem >> shift;
+}
+
+/*  Divides a limb array by a normalized divisor of at least two limbs 
+ *  with Knuth's Algorithm D (TAOCP vol. 2, 4.3.1). Each quotient limb is 
+ *  estimated from the top two limbs of the partial remainder, corrected 
+ *  with the second limb of the divisor so that it is at most one too 
+ *  large, and fixed by an add back when the subtraction borrows. u is 
+ *  reduced in place and its low dn limbs hold the remainder, q may be 
+ *  NULL when only the remainder is needed.
+ *
+ *  Input: quotient array of un - dn limbs, dividend limb array whose top 
+ *         limb is below the top limb of the divisor, its size, divisor 
+ *         limb array with the most significant bit set, its size
  *  Output:
  * 
  */
-void free_bn(BIGNUM *x){
-	free(x->digits);
-	free(x);
+static void divrem_limbs(uint64_t *q, uint64_t *u, int un, const uint64_t *d, int dn){
+	uint64_t d1 = d[dn - 1];
+	uint64_t d0 = d[dn - 2];
+	uint64_t v  = reciprocal_word(d1);
+
+	for(int j = un - dn - 1; j >= 0; j--){
+		uint64_t u2 = u[j + dn];
+		uint64_t u1 = u[j + dn - 1];
+		uint64_t u0 = u[j + dn - 2];
+		uint64_t qhat, rhat;
+
+		if(u2 == d1){
+			/* the estimate would not fit in a limb */
+			qhat = ~(uint64_t)0;
+			rhat = u1 + d1;
+		}else {
+			qhat = div_2by1_limbs(&rhat, u2, u1, d1, v);
+		}
+
+		if(u2 != d1 || rhat >= d1){
+			while((uint128_t)qhat * d0 > (((uint128_t)rhat << 64) | u0)){
+				qhat--;
+				rhat += d1;
+
+				if(rhat < d1){
+					break;
+				}
+			}
+		}
+
+		uint64_t borrow = submul_1_limbs(u + j, d, dn, qhat);
+		u[j + dn] = u2 - borrow;
+
+		if(borrow > u2){
+			qhat--;
+			u[j + dn] += add_limbs(u + j, u + j, dn, d, dn);
+		}
+
+		if(q != NULL){
+			q[j] = qhat;
+		}
+	}
+}
+
+/*  Sets the number of limbs in use, growing the buffer if needed. New 
+ *  limbs are not initialized.
+ *
+ *  Input: a big number pointer, the new size in limbs
+ *  Output:
+ * 
+ */
+static void resize_bn(BIGNUM *x, int n){
+	reserve_bn(x, n);
+	x->size = n;
+}
+
+/*  Exchanges the contents of two big numbers without copying limbs
+ *
+ *  Input: two big numbers pointer
+ *  Output:
+ * 
+ */
+static void swap_bn(BIGNUM *a, BIGNUM *b){
+	BIGNUM t = *a;
+	*a = *b;
+	*b = t;
+
+	/* inline limbs moved with the structs, their pointers did not */
+	if(a->digits == b->small){
+		a->digits = a->small;
+	}
+	if(b->digits == a->small){
+		b->digits = b->small;
+	}
+}
+
+/*  Frees the limbs of a big number unless they are inline or borrowed
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+static void free_digits_bn(BIGNUM *x){
+	if(!x->borrowed && x->digits != x->small){
+		free(x->digits);
+	}
+}
+
+/*  Sets a big number to a single limb value
+ *
+ *  Input: a big number pointer, the value
+ *  Output:
+ * 
+ */
+static void set_word_bn(BIGNUM *x, uint64_t value){
+	resize_bn(x, 1);
+	x->digits[0] = value;
+	x->sign = 1;
+
+	rmzero_bn(x);
+}
+
+/*  Frees the default context of a thread when it exits
+ *
+ *  Input: the context
+ *  Output:
+ * 
+ */
+static void free_default_ctx_bn(void *ctx){
+	if(ctx == default_ctx){
+		default_ctx = NULL;
+	}
+
+	free_ctx_bn((BN_CTX*)ctx);
+}
+
+/*  Creates the key whose destructor frees the default contexts
+ *
+ *  Input:
+ *  Output:
+ * 
+ */
+static void make_default_ctx_key(void){
+	default_ctx_key_ready = pthread_key_create(&default_ctx_key, free_default_ctx_bn) == 0;
+}
+
+/*  Opens a scratch frame on the context of the calling thread, the 
+ *  bound one or else the default context of the thread, which is created 
+ *  on the first call. When the context cannot be registered with 
+ *  default_ctx_key it is kept as transient and freed by leave_ctx_bn.
+ *
+ *  Input:
+ *  Output: the context holding the frame
+ * 
+ */
+static BN_CTX* enter_ctx_bn(){
+	BN_CTX *ctx = thread_ctx;
+
+	if(ctx == NULL){
+		if(default_ctx == NULL && transient_ctx == NULL){
+			ctx = init_ctx_bn();
+
+			pthread_once(&default_ctx_once, make_default_ctx_key);
+
+			if(default_ctx_key_ready && pthread_setspecific(default_ctx_key, ctx) == 0){
+				default_ctx = ctx;
+			}else{
+				transient_ctx = ctx;
+			}
+		}
+
+		ctx = default_ctx != NULL ? default_ctx : transient_ctx;
+	}
+
+	start_ctx_bn(ctx);
+	return ctx;
+}
+
+/*  Closes the frame opened by enter_ctx_bn, releasing a transient 
+ *  context once the outermost operation is done
+ *
+ *  Input: the context returned by enter_ctx_bn
+ *  Output:
+ * 
+ */
+static void leave_ctx_bn(BN_CTX *ctx){
+	end_ctx_bn(ctx);
+
+	if(ctx->depth == 0 && ctx == transient_ctx){
+		transient_ctx = NULL;
+		free_ctx_bn(ctx);
+	}
+}
+
+/*  Scratch limbs needed by kara_mul_limbs for operands of n limbs
+ *
+ *  Input: operand size in limbs
+ *  Output: number of scratch limbs
+ * 
+ */
+static int kara_scratch_limbs(int n){
+	if(n < KARATSUBA_THRESHOLD){
+		return 0;
+	}
+
+	int l = (n + 1) / 2;
+	return 4 * l + max(kara_scratch_limbs(l), 2 * l + 1);
+}
+
+/*  Multiplies two limb arrays of n limbs each with the Karatsuba 
+ *  algorithm. The operands are split by offset into a low half of l limbs 
+ *  and a high half of h limbs and the middle product is obtained as
+ *  a0*b0 + a1*b1 - (a0 - a1)(b0 - b1), which needs no carry limb in the 
+ *  recursive call. r must not overlap the operands and must hold 2n limbs.
+ *
+ *  Input: result array, first limb array, second limb array, their size,
+ *         scratch array of kara_scratch_limbs(n) limbs
+ *  Output:
+ * 
+ */
+static void kara_mul_limbs(uint64_t *r, const uint64_t *a, const uint64_t *b, int n, uint64_t *ws){
+	if(n < KARATSUBA_THRESHOLD){
+		mul_basecase_limbs(r, a, n, b, n);
+		return;
+	}
+
+	int l = (n + 1) / 2;
+	int h = n - l;
+
+	uint64_t *da  = ws;
+	uint64_t *db  = ws + l;
+	uint64_t *tmp = ws + 2 * l;
+	uint64_t *next = ws + 4 * l;
+
+	int neg = abs_sub_limbs(da, a, l, a + l, h) ^ abs_sub_limbs(db, b, l, b + l, h);
+
+	kara_mul_limbs(tmp, da, db, l, next);
+	kara_mul_limbs(r, a, b, l, next);
+	kara_mul_limbs(r + 2 * l, a + l, b + l, h, next);
+
+	/* middle term z0 + z2 -/+ |a0 - a1||b0 - b1| */
+	uint64_t *t = next;
+	t[2 * l] = add_limbs(t, r, 2 * l, r + 2 * l, 2 * h);
+
+	if(neg){
+		t[2 * l] += add_limbs(t, t, 2 * l, tmp, 2 * l);
+	}else {
+		t[2 * l] -= sub_limbs(t, t, 2 * l, tmp, 2 * l);
+	}
+
+	int tn = 2 * l + 1;
+	while(tn > 0 && t[tn - 1] == 0){
+		tn--;
+	}
+
+	add_limbs(r + l, r + l, l + 2 * h, t, tn);
+}
+
+/*  Scratch limbs needed by kara_sqr_limbs for an operand of n limbs
+ *
+ *  Input: operand size in limbs
+ *  Output: number of scratch limbs
+ * 
+ */
+static int kara_sqr_scratch_limbs(int n){
+	if(n < SQR_KARATSUBA_THRESHOLD){
+		return 0;
+	}
+
+	int l = (n + 1) / 2;
+	return 3 * l + max(kara_sqr_scratch_limbs(l), 2 * l + 1);
+}
+
+/*  Squares a limb array of n limbs with the Karatsuba algorithm, the 
+ *  middle product being a0^2 + a1^2 - (a0 - a1)^2, so only three squares 
+ *  of half size are needed. r must not overlap a and must hold 2n limbs.
+ *
+ *  Input: result array, limb array, its size, scratch array of
+ *         kara_sqr_scratch_limbs(n) limbs
+ *  Output:
+ * 
+ */
+static void kara_sqr_limbs(uint64_t *r, const uint64_t *a, int n, uint64_t *ws){
+	if(n < SQR_KARATSUBA_THRESHOLD){
+		sqr_basecase_limbs(r, a, n);
+		return;
+	}
+
+	int l = (n + 1) / 2;
+	int h = n - l;
+
+	uint64_t *da  = ws;
+	uint64_t *tmp = ws + l;
+	uint64_t *next = ws + 3 * l;
+
+	abs_sub_limbs(da, a, l, a + l, h);
+
+	kara_sqr_limbs(tmp, da, l, next);
+	kara_sqr_limbs(r, a, l, next);
+	kara_sqr_limbs(r + 2 * l, a + l, h, next);
+
+	/* middle term z0 + z2 - (a0 - a1)^2 */
+	uint64_t *t = next;
+	t[2 * l] = add_limbs(t, r, 2 * l, r + 2 * l, 2 * h);
+	t[2 * l] -= sub_limbs(t, t, 2 * l, tmp, 2 * l);
+
+	int tn = 2 * l + 1;
+	while(tn > 0 && t[tn - 1] == 0){
+		tn--;
+	}
+
+	add_limbs(r + l, r + l, l + 2 * h, t, tn);
+}
+
+/*  Multiplies a big number by a signed machine word, result may alias x
+ *
+ *  Input: a big number pointer, the multiplier, a big number pointer
+ *  Output:
+ * 
+ */
+static void mul_si_bn(BIGNUM *x, int64_t s, BIGNUM *result){
+	uint64_t m = s < 0 ? -(uint64_t)s : (uint64_t)s;
+	uint8_t sign = x->sign == (s >= 0);
+	int n = x->size;
+
+	reserve_bn(result, n + 1);
+	result->digits[n] = mul_1_limbs(result->digits, x->digits, n, m);
+
+	result->size = n + 1;
+	result->sign = sign;
+	rmzero_bn(result);
+}
+
+/*  Negates a limb array in two's complement, r may alias a
+ *
+ *  Input: result array, limb array, its size
+ *  Output:
+ * 
+ */
+static void neg_limbs(uint64_t *r, const uint64_t *a, int n){
+	int i = 0;
+
+	for(; i < n && a[i] == 0; i++){
+		r[i] = 0;
+	}
+
+	if(i < n){
+		r[i] = -a[i];
+
+		for(i++; i < n; i++){
+			r[i] = ~a[i];
+		}
+	}
+}
+
+/*  Divides a limb array in two's complement by a signed machine word that 
+ *  is known to divide it exactly, in place. The power of two is shifted 
+ *  out arithmetically and the odd part is divided modulo 2^(64 n).
+ *
+ *  Input: limb array, its size, the divisor
+ *  Output:
+ * 
+ */
+static void divexact_si_limbs(uint64_t *a, int n, int64_t d){
+	uint64_t m = d < 0 ? -(uint64_t)d : (uint64_t)d;
+	int shift = __builtin_ctzll(m);
+
+	if(shift){
+		int64_t top = (int64_t)a[n - 1];
+
+		rshift_limbs(a, a, n, shift);
+		a[n - 1] = (uint64_t)(top >> shift);
+		m >>= shift;
+	}
+
+	if(m > 1){
+		divexact_1_limbs(a, a, n, m);
+	}
+
+	if(d < 0){
+		neg_limbs(a, a, n);
+	}
+}
+
+/*  Replaces r by a - s r in two's complement for a signed machine word s
+ *
+ *  Input: result array, limb array, their size, the multiplier
+ *  Output:
+ * 
+ */
+static void rsbmul_si_limbs(uint64_t *r, const uint64_t *a, int n, int64_t s){
+	uint64_t m = s < 0 ? -(uint64_t)s : (uint64_t)s;
+
+	if(m == 0){
+		memcpy(r, a, n * sizeof(uint64_t));
+		return;
+	}
+
+	if(m != 1){
+		mul_1_limbs(r, r, n, m);
+	}
+
+	if(s > 0){
+		sub_limbs(r, a, n, r, n);
+	}else {
+		add_limbs(r, r, n, a, n);
+	}
+}
+
+/*  Finite evaluation points of the Toom-Cook multiplications, the point 
+ *  at infinity is always used as well
+ */
+static const int64_t toom_points[] = {0, 1, -1, 2, -2, 3, -3};
+
+/*  Evaluates the pieces of k limbs of a limb array of the given parity 
+ *  by Horner's rule in p^2, into k + 1 limbs
+ *
+ *  Input: result array, limb array and its size, number of pieces, piece 
+ *         size, parity of the pieces taken, the square of the point
+ *  Output:
+ * 
+ */
+static void toom_horner_limbs(uint64_t *r, const uint64_t *x, int xn, int kx, int k, int parity, uint64_t p2){
+	memset(r, 0, (k + 1) * sizeof(uint64_t));
+
+	for(int i = kx - 1 - ((kx - 1 - parity) & 1); i >= parity; i -= 2){
+		int size = xn - i * k < k ? xn - i * k : k;
+
+		if(p2 != 1){
+			mul_1_limbs(r, r, k + 1, p2);
+		}
+		if(size > 0){
+			add_limbs(r, r, k + 1, x + i * k, size);
+		}
+	}
+}
+
+/*  Evaluates the polynomial whose coefficients are the pieces of k limbs 
+ *  of a limb array at p > 0 and, when em is not NULL, at -p. The values 
+ *  are the even part plus or minus the odd part, kept as magnitudes of 
+ *  k + 1 limbs.
+ *
+ *  Input: array for the value at p, array for the magnitude at -p or 
+ *         NULL, limb array and its size, number of pieces, piece size, 
+ *         the point, scratch array of k + 1 limbs
+ *  Output: 1 if the value at -p is negative, 0 otherwise
+ * 
+ */
+static int toom_eval_limbs(uint64_t *ep, uint64_t *em, const uint64_t *x, int xn, int kx, int k, int64_t p, uint64_t *t){
+	int neg = 0;
+
+	toom_horner_limbs(ep, x, xn, kx, k, 0, (uint64_t)(p * p));
+	toom_horner_limbs(t, x, xn, kx, k, 1, (uint64_t)(p * p));
+
+	if(p != 1){
+		mul_1_limbs(t, t, k + 1, (uint64_t)p);
+	}
+
+	if(em != NULL){
+		neg = abs_sub_limbs(em, ep, k + 1, t, k + 1);
+	}
+	add_limbs(ep, ep, k + 1, t, k + 1);
+
+	return neg;
+}
+
+static void mul_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn);
+static void sqr_limbs(uint64_t *r, const uint64_t *a, int n);
+
+/*  Multiplies two limb arrays with leading zeros into w limbs, squaring 
+ *  when asked to
+ *
+ *  Input: result array, its size, first limb array and its size, second 
+ *         limb array and its size, 1 to square the first array
+ *  Output:
+ * 
+ */
+static void toom_product_limbs(uint64_t *r, int w, const uint64_t *x, int xn, const uint64_t *y, int yn, int square){
+	while(xn > 0 && x[xn - 1] == 0){
+		xn--;
+	}
+	while(yn > 0 && y[yn - 1] == 0){
+		yn--;
+	}
+
+	int used = 0;
+
+	if(square){
+		if(xn > 0){
+			sqr_limbs(r, x, xn);
+			used = 2 * xn;
+		}
+	}else if(xn > 0 && yn > 0){
+		if(xn >= yn){
+			mul_limbs(r, x, xn, y, yn);
+		}else {
+			mul_limbs(r, y, yn, x, xn);
+		}
+		used = xn + yn;
+	}
+
+	memset(r + used, 0, (w - used) * sizeof(uint64_t));
+}
+
+/*  Multiplies two limb arrays with the Toom-Cook method, splitting the 
+ *  first one in ka pieces and the second in kb pieces of k limbs, so that 
+ *  balanced (3x3, 4x4) and unbalanced (3x2, 4x2) shapes share the code. 
+ *  The product polynomial is evaluated at ka + kb - 1 points by recursive 
+ *  multiplications and interpolated with Newton divided differences, 
+ *  whose divisions by the distances between points are all exact. Every 
+ *  value of the interpolation fits in 2k + 2 limbs of two's complement, 
+ *  so it runs as a fixed sequence of linear passes over preallocated 
+ *  scratch. When both operands are the same array each point needs one 
+ *  evaluation and a square. r must not overlap the operands and must 
+ *  hold an + bn limbs.
+ *
+ *  Input: result array, first limb array and its size, second limb 
+ *         array and its size, number of pieces of each operand
+ *  Output:
+ * 
+ */
+static void toom_mul_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn, int ka, int kb){
+	int k = max((an + ka - 1) / ka, (bn + kb - 1) / kb);
+	int m = ka + kb - 1;
+	int w = 2 * k + 2;
+	int square = a == b && an == bn && ka == kb;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *scratch = get_ctx_bn(ctx);
+	reserve_bn(scratch, (2 * m - 1) * w + 5 * (k + 1));
+
+	uint64_t *v[7], *c[7];
+
+	for(int j = 0; j < m; j++){
+		v[j] = scratch->digits + j * w;
+	}
+	for(int j = 0; j < m - 1; j++){
+		c[j] = scratch->digits + (m + j) * w;
+	}
+
+	uint64_t *eap = scratch->digits + (2 * m - 1) * w;
+	uint64_t *eam = eap + (k + 1);
+	uint64_t *ebp = eam + (k + 1);
+	uint64_t *ebm = ebp + (k + 1);
+	uint64_t *t   = ebm + (k + 1);
+	int neg = 0;
+
+	/* the value at infinity is the product of the leading pieces, it is 
+	   removed from the other values so that m - 1 points are left */
+	int la = an - (ka - 1) * k, lb = bn - (kb - 1) * k;
+
+	toom_product_limbs(v[m - 1], w, a + (ka - 1) * k, la, b + (kb - 1) * k, lb, square);
+
+	for(int j = 0; j < m - 1; j++){
+		int64_t p = toom_points[j], pm = 1;
+
+		if(p == 0){
+			toom_product_limbs(v[j], w, a, an < k ? an : k, b, bn < k ? bn : k, square);
+
+		}else if(p > 0){
+			/* the value at -p, when needed, comes from the same halves */
+			int both = j + 1 < m - 1;
+
+			neg = toom_eval_limbs(eap, both ? eam : NULL, a, an, ka, k, p, t);
+			if(!square){
+				neg ^= toom_eval_limbs(ebp, both ? ebm : NULL, b, bn, kb, k, p, t);
+			}
+
+			toom_product_limbs(v[j], w, eap, k + 1, ebp, k + 1, square);
+
+		}else {
+			toom_product_limbs(v[j], w, eam, k + 1, ebm, k + 1, square);
+
+			if(neg && !square){
+				neg_limbs(v[j], v[j], w);
+			}
+		}
+
+		for(int i = 0; i < m - 1; i++){
+			pm *= p;
+		}
+
+		if(pm > 0){
+			submul_1_limbs(v[j], v[m - 1], w, (uint64_t)pm);
+		}else if(pm < 0){
+			addmul_1_limbs(v[j], v[m - 1], w, -(uint64_t)pm);
+		}
+	}
+
+	/* divided differences, v[j] becomes f[p0, ..., pj] */
+	for(int l = 1; l < m - 1; l++){
+		for(int j = m - 2; j >= l; j--){
+			sub_limbs(v[j], v[j], w, v[j - 1], w);
+			divexact_si_limbs(v[j], w, toom_points[j] - toom_points[j - l]);
+		}
+	}
+
+	/* Newton form to coefficients, multiplying by (x - pj) from the inside */
+	memcpy(c[0], v[m - 2], w * sizeof(uint64_t));
+
+	for(int j = m - 3, deg = 0; j >= 0; j--){
+		int64_t p = toom_points[j];
+
+		deg++;
+		memcpy(c[deg], c[deg - 1], w * sizeof(uint64_t));
+
+		for(int i = deg - 1; i >= 1; i--){
+			rsbmul_si_limbs(c[i], c[i - 1], w, p);
+		}
+
+		rsbmul_si_limbs(c[0], v[j], w, p);
+	}
+
+	memset(r, 0, (an + bn) * sizeof(uint64_t));
+
+	for(int i = 0; i < m; i++){
+		uint64_t *x = i < m - 1 ? c[i] : v[m - 1];
+		int xn = an + bn - i * k < w ? an + bn - i * k : w;
+
+		while(xn > 0 && x[xn - 1] == 0){
+			xn--;
+		}
+
+		if(xn > 0){
+			add_limbs(r + i * k, r + i * k, an + bn - i * k, x, xn);
+		}
+	}
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Montgomery reduction modulo a prime below 2^63, R = 2^64
+ *
+ *  Input: value below p * 2^64, the prime, -p^-1 mod 2^64
+ *  Output: t * R^-1 mod p
+ * 
+ */
+static inline uint64_t redc_word(uint128_t t, uint64_t p, uint64_t pinv){
+	uint64_t m = (uint64_t)t * pinv;
+	uint64_t r = (uint64_t)((t + (uint128_t)m * p) >> 64);
+
+	return r >= p ? r - p : r;
+}
+
+/*  Multiplies two words in Montgomery form modulo a prime below 2^63
+ *
+ *  Input: two values below p, the prime, -p^-1 mod 2^64
+ *  Output: a * b * R^-1 mod p
+ * 
+ */
+static inline uint64_t mulmod_word(uint64_t a, uint64_t b, uint64_t p, uint64_t pinv){
+	return redc_word((uint128_t)a * b, p, pinv);
+}
+
+/*  Adds two words modulo a prime below 2^63
+ *
+ *  Input: two values below p, the prime
+ *  Output: a + b mod p
+ * 
+ */
+static inline uint64_t addmod_word(uint64_t a, uint64_t b, uint64_t p){
+	uint64_t s = a + b;
+
+	return s >= p ? s - p : s;
+}
+
+/*  Subtracts two words modulo a prime below 2^63
+ *
+ *  Input: two values below p, the prime
+ *  Output: a - b mod p
+ * 
+ */
+static inline uint64_t submod_word(uint64_t a, uint64_t b, uint64_t p){
+	return a >= b ? a - b : a + p - b;
+}
+
+/*  Computes a power of a word modulo a prime below 2^63 in Montgomery form
+ *
+ *  Input: base in Montgomery form, exponent, R mod p, the prime, 
+ *         -p^-1 mod 2^64
+ *  Output: the power in Montgomery form
+ * 
+ */
+static uint64_t powmod_word(uint64_t b, uint64_t e, uint64_t one, uint64_t p, uint64_t pinv){
+	uint64_t r = one;
+
+	for(; e; e >>= 1){
+		if(e & 1){
+			r = mulmod_word(r, b, p, pinv);
+		}
+		b = mulmod_word(b, b, p, pinv);
+	}
+
+	return r;
+}
+
+/*  Computes -p^-1 mod 2^64 of an odd word by Newton iteration
+ *
+ *  Input: an odd word
+ *  Output: the negated inverse
+ * 
+ */
+static uint64_t neg_inverse_word(uint64_t p){
+	uint64_t inv = p;
+
+	for(int i = 0; i < 5; i++){
+		inv *= 2 - p * inv;
+	}
+
+	return -inv;
+}
+
+/*  Forward transform by decimation in frequency, the output is left in 
+ *  bit reversed order
+ *
+ *  Input: array in Montgomery form, its size (a power of two), table 
+ *         with the powers of the root of order 2 len at tw[len + j], 
+ *         the prime, -p^-1 mod 2^64
+ *  Output:
+ * 
+ */
+static void ntt_forward(uint64_t *a, int n, const uint64_t *tw, uint64_t p, uint64_t pinv){
+	for(int len = n / 2; len >= 1; len /= 2){
+		for(int i = 0; i < n; i += 2 * len){
+			for(int j = 0; j < len; j++){
+				uint64_t u = a[i + j], v = a[i + j + len];
+				uint64_t s = u + v;
+
+				a[i + j]       = s >= p ? s - p : s;
+				a[i + j + len] = mulmod_word(u >= v ? u - v : u + p - v, tw[len + j], p, pinv);
+			}
+		}
+	}
+}
+
+/*  Inverse transform by decimation in time, taking the input in bit 
+ *  reversed order and leaving it unscaled
+ *
+ *  Input: array in Montgomery form, its size (a power of two), table 
+ *         with the inverse powers laid out as in ntt_forward, the prime,
+ *         -p^-1 mod 2^64
+ *  Output:
+ * 
+ */
+static void ntt_inverse(uint64_t *a, int n, const uint64_t *tw, uint64_t p, uint64_t pinv){
+	for(int len = 1; len < n; len *= 2){
+		for(int i = 0; i < n; i += 2 * len){
+			for(int j = 0; j < len; j++){
+				uint64_t u = a[i + j];
+				uint64_t v = mulmod_word(a[i + j + len], tw[len + j], p, pinv);
+				uint64_t s = u + v;
+
+				a[i + j]       = s >= p ? s - p : s;
+				a[i + j + len] = u >= v ? u - v : u + p - v;
+			}
+		}
+	}
+}
+
+/*  Radix-3 stage of a forward transform of 3m points by decimation in 
+ *  frequency. It leaves three blocks of m points, each to be transformed 
+ *  by ntt_forward with the root w^3, whose outputs are the coefficients 
+ *  3q, 3q + 1 and 3q + 2. With w^m the cube root of unity omega, the 
+ *  butterfly uses omega^2 = -1 - omega and needs one multiplication.
+ *
+ *  Input: array in Montgomery form, size of the blocks, root of order 3m, 
+ *         omega, R mod p, the prime, -p^-1 mod 2^64
+ *  Output:
+ * 
+ */
+static void ntt_radix3_forward(uint64_t *a, int m, uint64_t w, uint64_t omega, uint64_t one, uint64_t p, uint64_t pinv){
+	uint64_t w2 = mulmod_word(w, w, p, pinv);
+	uint64_t t1 = one, t2 = one;
+
+	for(int i = 0; i < m; i++){
+		uint64_t x0 = a[i], x1 = a[i + m], x2 = a[i + 2 * m];
+		uint64_t u  = mulmod_word(submod_word(x1, x2, p), omega, p, pinv);
+
+		a[i]         = addmod_word(x0, addmod_word(x1, x2, p), p);
+		a[i + m]     = mulmod_word(addmod_word(submod_word(x0, x2, p), u, p), t1, p, pinv);
+		a[i + 2 * m] = mulmod_word(submod_word(submod_word(x0, x1, p), u, p), t2, p, pinv);
+
+		t1 = mulmod_word(t1, w, p, pinv);
+		t2 = mulmod_word(t2, w2, p, pinv);
+	}
+}
+
+/*  Radix-3 stage of an inverse transform of 3m points, undoing 
+ *  ntt_radix3_forward once each block went through ntt_inverse. The 
+ *  result is left unscaled.
+ *
+ *  Input: array in Montgomery form, size of the blocks, inverse of the 
+ *         root of order 3m, omega, R mod p, the prime, -p^-1 mod 2^64
+ *  Output:
+ * 
+ */
+static void ntt_radix3_inverse(uint64_t *a, int m, uint64_t wi, uint64_t omega, uint64_t one, uint64_t p, uint64_t pinv){
+	uint64_t wi2 = mulmod_word(wi, wi, p, pinv);
+	uint64_t t1 = one, t2 = one;
+
+	for(int i = 0; i < m; i++){
+		uint64_t z0 = a[i];
+		uint64_t z1 = mulmod_word(a[i + m], t1, p, pinv);
+		uint64_t z2 = mulmod_word(a[i + 2 * m], t2, p, pinv);
+		uint64_t u  = mulmod_word(submod_word(z1, z2, p), omega, p, pinv);
+
+		a[i]         = addmod_word(z0, addmod_word(z1, z2, p), p);
+		a[i + m]     = submod_word(submod_word(z0, z1, p), u, p);
+		a[i + 2 * m] = addmod_word(submod_word(z0, z2, p), u, p);
+
+		t1 = mulmod_word(t1, wi, p, pinv);
+		t2 = mulmod_word(t2, wi2, p, pinv);
+	}
+}
+
+/*  Computes the cyclic convolution of two limb arrays modulo one of the 
+ *  NTT primes, the result is in normal form and overwrites fa. A square 
+ *  is detected by both operands being the same array and transforms once. 
+ *  A size of 3 times a power of two starts with a radix-3 stage and runs 
+ *  the power of two transforms on its three blocks.
+ *
+ *  Input: index of the prime, transform size (2^j or 3 * 2^j), the 
+ *         operands, their sizes, transform buffers of n limbs for each 
+ *         operand, twiddle buffer of n limbs
+ *  Output:
+ * 
+ */
+static void ntt_convolution(int k, int n, const uint64_t *a, int an, const uint64_t *b, int bn, uint64_t *fa, uint64_t *fb, uint64_t *tw){
+	uint64_t p    = ntt_primes[k];
+	uint64_t pinv = neg_inverse_word(p);
+	uint64_t one  = (uint64_t)(((uint128_t)1 << 64) % p);
+	uint64_t r2   = (uint64_t)(((uint128_t)one * one) % p);
+
+	uint64_t g  = mulmod_word(ntt_generators[k], r2, p, pinv);
+	uint64_t gi = powmod_word(g, p - 2, one, p, pinv);
+
+	/* a limb times R^2 is below p * 2^64, so reducing it maps the limb to 
+	   Montgomery form directly */
+	int square = a == b && an == bn;
+
+	for(int i = 0; i < n; i++){
+		fa[i] = i < an ? mulmod_word(a[i], r2, p, pinv) : 0;
+	}
+	if(!square){
+		for(int i = 0; i < n; i++){
+			fb[i] = i < bn ? mulmod_word(b[i], r2, p, pinv) : 0;
+		}
+	}
+
+	/* size of the power of two transforms and number of blocks */
+	int m = n % 3 == 0 ? n / 3 : n;
+	int blocks = n / m;
+
+	uint64_t omega = powmod_word(g, (p - 1) / 3, one, p, pinv);
+
+	for(int len = 1; len < m; len *= 2){
+		uint64_t w = powmod_word(g, (p - 1) / (2 * len), one, p, pinv);
+
+		tw[len] = one;
+		for(int j = 1; j < len; j++){
+			tw[len + j] = mulmod_word(tw[len + j - 1], w, p, pinv);
+		}
+	}
+
+	if(blocks == 3){
+		uint64_t w = powmod_word(g, (p - 1) / n, one, p, pinv);
+
+		ntt_radix3_forward(fa, m, w, omega, one, p, pinv);
+		if(!square){
+			ntt_radix3_forward(fb, m, w, omega, one, p, pinv);
+		}
+	}
+
+	for(int i = 0; i < blocks; i++){
+		ntt_forward(fa + i * m, m, tw, p, pinv);
+	}
+
+	if(square){
+		fb = fa;
+	}else {
+		for(int i = 0; i < blocks; i++){
+			ntt_forward(fb + i * m, m, tw, p, pinv);
+		}
+	}
+
+	for(int i = 0; i < n; i++){
+		fa[i] = mulmod_word(fa[i], fb[i], p, pinv);
+	}
+
+	for(int len = 1; len < m; len *= 2){
+		uint64_t w = powmod_word(gi, (p - 1) / (2 * len), one, p, pinv);
+
+		tw[len] = one;
+		for(int j = 1; j < len; j++){
+			tw[len + j] = mulmod_word(tw[len + j - 1], w, p, pinv);
+		}
+	}
+
+	for(int i = 0; i < blocks; i++){
+		ntt_inverse(fa + i * m, m, tw, p, pinv);
+	}
+
+	if(blocks == 3){
+		uint64_t wi = powmod_word(gi, (p - 1) / n, one, p, pinv);
+
+		ntt_radix3_inverse(fa, m, wi, omega, one, p, pinv);
+	}
+
+	/* a plain n^-1 both scales and leaves Montgomery form */
+	uint64_t ninv = p - (p - 1) / n;
+
+	for(int i = 0; i < n; i++){
+		fa[i] = mulmod_word(fa[i], ninv, p, pinv);
+	}
+}
+
+/*  Multiplies two limb arrays with a number theoretic transform modulo 
+ *  three primes, recombining each coefficient of the convolution with 
+ *  Garner's formula. Everything is exact 64-bit modular arithmetic. The 
+ *  transform takes the smallest size 2^j or 3 * 2^j that holds the 
+ *  product, so padding grows it by at most 1.5 times instead of 2. r 
+ *  must not overlap the operands and must hold an + bn limbs.
+ *
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size
+ *  Output:
+ * 
+ */
+static void ntt_mul_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	int n = 1;
+	while(n < an + bn - 1){
+		n *= 2;
+	}
+
+	if(n % 4 == 0 && n / 4 * 3 >= an + bn - 1){
+		n = n / 4 * 3;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *scratch = get_ctx_bn(ctx);
+	reserve_bn(scratch, 5 * n);
+
+	uint64_t *c[3] = { scratch->digits, scratch->digits + n, scratch->digits + 2 * n };
+	uint64_t *fb = scratch->digits + 3 * n;
+	uint64_t *tw = scratch->digits + 4 * n;
+
+	for(int k = 0; k < 3; k++){
+		ntt_convolution(k, n, a, an, b, bn, c[k], fb, tw);
+	}
+
+	uint64_t p1 = ntt_primes[0], p2 = ntt_primes[1], p3 = ntt_primes[2];
+	uint64_t pinv2 = neg_inverse_word(p2), pinv3 = neg_inverse_word(p3);
+	uint64_t one2  = (uint64_t)(((uint128_t)1 << 64) % p2);
+	uint64_t one3  = (uint64_t)(((uint128_t)1 << 64) % p3);
+
+	/* inverses in Montgomery form, so that one multiplication by them 
+	   yields a plain result */
+	uint64_t r22 = (uint64_t)(((uint128_t)one2 * one2) % p2);
+	uint64_t r23 = (uint64_t)(((uint128_t)one3 * one3) % p3);
+	uint64_t inv12 = powmod_word(mulmod_word(p1 % p2, r22, p2, pinv2), p2 - 2, one2, p2, pinv2);
+	uint64_t inv13 = powmod_word(mulmod_word(p1 % p3, r23, p3, pinv3), p3 - 2, one3, p3, pinv3);
+	uint64_t inv23 = powmod_word(mulmod_word(p2 % p3, r23, p3, pinv3), p3 - 2, one3, p3, pinv3);
+
+	uint128_t p12 = (uint128_t)p1 * p2;
+	uint128_t carry = 0;
+
+	for(int i = 0; i < an + bn - 1; i++){
+		uint64_t x1 = c[0][i], x2 = c[1][i], x3 = c[2][i];
+
+		uint64_t y1 = x1 >= p2 ? x1 - p2 : x1;
+		uint64_t t2 = mulmod_word(x2 >= y1 ? x2 - y1 : x2 + p2 - y1, inv12, p2, pinv2);
+
+		uint64_t z1 = x1 >= p3 ? x1 - p3 : x1;
+		uint64_t u  = mulmod_word(x3 >= z1 ? x3 - z1 : x3 + p3 - z1, inv13, p3, pinv3);
+		uint64_t z2 = t2 >= p3 ? t2 - p3 : t2;
+		uint64_t t3 = mulmod_word(u >= z2 ? u - z2 : u + p3 - z2, inv23, p3, pinv3);
+
+		/* x = x1 + p1 t2 + p1 p2 t3, three limbs */
+		uint128_t lo = (uint128_t)p1 * t2 + x1;
+		uint128_t m0 = (uint128_t)(uint64_t)p12 * t3;
+		uint128_t m1 = (uint128_t)(uint64_t)(p12 >> 64) * t3;
+
+		uint128_t s0 = (uint128_t)(uint64_t)lo + (uint64_t)m0 + (uint64_t)carry;
+		r[i] = (uint64_t)s0;
+
+		carry = (lo >> 64) + (m0 >> 64) + m1 + (carry >> 64) + (s0 >> 64);
+	}
+
+	r[an + bn - 1] = (uint64_t)carry;
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Multiplies two limb arrays, an >= bn > 0, choosing the algorithm by 
+ *  size. Operands too unbalanced for the Toom-Cook shapes are multiplied 
+ *  in bn sized pieces of the larger one. r must not overlap the operands 
+ *  and must hold an + bn limbs.
+ *
+ *  Input: result array, first limb array and its size, second limb
+ *         array and its size
+ *  Output:
+ * 
+ */
+static void mul_limbs(uint64_t *r, const uint64_t *a, int an, const uint64_t *b, int bn){
+	if(bn < KARATSUBA_THRESHOLD){
+		mul_basecase_limbs(r, a, an, b, bn);
+		return;
+	}
+
+	if(an > bn && bn < NTT_THRESHOLD && (bn < TOOM3_THRESHOLD || an * 2 >= bn * 5)){
+		BN_CTX *ctx = enter_ctx_bn();
+
+		BIGNUM *scratch = get_ctx_bn(ctx);
+		reserve_bn(scratch, 2 * bn);
+
+		uint64_t *t = scratch->digits;
+
+		mul_limbs(r, a, bn, b, bn);
+		memset(r + 2 * bn, 0, (an - bn) * sizeof(uint64_t));
+
+		int done = bn;
+
+		for(; an - done >= bn; done += bn){
+			mul_limbs(t, a + done, bn, b, bn);
+			add_limbs(r + done, r + done, an + bn - done, t, 2 * bn);
+		}
+
+		if(an > done){
+			mul_limbs(t, b, bn, a + done, an - done);
+			add_limbs(r + done, r + done, an + bn - done, t, bn + an - done);
+		}
+
+		leave_ctx_bn(ctx);
+
+	}else if(bn >= NTT_THRESHOLD){
+		ntt_mul_limbs(r, a, an, b, bn);
+
+	}else if(bn < TOOM3_THRESHOLD){
+		BN_CTX *ctx = enter_ctx_bn();
+
+		BIGNUM *scratch = get_ctx_bn(ctx);
+		reserve_bn(scratch, kara_scratch_limbs(bn));
+
+		kara_mul_limbs(r, a, b, bn, scratch->digits);
+
+		leave_ctx_bn(ctx);
+
+	}else if(an * 4 < bn * 5){
+		int k = bn < TOOM4_THRESHOLD ? 3 : 4;
+		toom_mul_limbs(r, a, an, b, bn, k, k);
+
+	}else if(an * 4 < bn * 7){
+		toom_mul_limbs(r, a, an, b, bn, 3, 2);
+
+	}else {
+		toom_mul_limbs(r, a, an, b, bn, 4, 2);
+	}
+}
+
+/*  Squares a limb array of n > 0 limbs, choosing the algorithm by size. 
+ *  r must not overlap a and must hold 2n limbs.
+ *
+ *  Input: result array, limb array and its size
+ *  Output:
+ * 
+ */
+static void sqr_limbs(uint64_t *r, const uint64_t *a, int n){
+	if(n < SQR_KARATSUBA_THRESHOLD){
+		sqr_basecase_limbs(r, a, n);
+
+	}else if(n >= SQR_NTT_THRESHOLD){
+		ntt_mul_limbs(r, a, n, a, n);
+
+	}else if(n < SQR_TOOM3_THRESHOLD){
+		BN_CTX *ctx = enter_ctx_bn();
+
+		BIGNUM *scratch = get_ctx_bn(ctx);
+		reserve_bn(scratch, kara_sqr_scratch_limbs(n));
+
+		kara_sqr_limbs(r, a, n, scratch->digits);
+
+		leave_ctx_bn(ctx);
+
+	}else {
+		int k = n < SQR_TOOM4_THRESHOLD ? 3 : 4;
+		toom_mul_limbs(r, a, n, a, n, k, k);
+	}
+}
+
+/*  Divides the 2n limbs of u by a normalized divisor of n limbs with the 
+ *  recursive method of Burnikel and Ziegler: the high half of the 
+ *  quotient comes from dividing the top limbs by the high half of the 
+ *  divisor, corrected by a multiplication by its low half, and the low 
+ *  half of the quotient likewise, so the work is done by the fast 
+ *  multiplications. The remainder is left in the low n limbs of u and 
+ *  the top n limbs are destroyed.
+ *
+ *  Input: quotient array of n limbs, dividend limb array, divisor limb 
+ *         array with the most significant bit set, its size, scratch 
+ *         array of n limbs
+ *  Output: the quotient limb above the n limbs written to q, 0 or 1
+ * 
+ */
+static uint64_t dc_div_n_limbs(uint64_t *q, uint64_t *u, const uint64_t *d, int n, uint64_t *tp){
+	if(n < DC_DIV_THRESHOLD || n < 4){
+		uint64_t qh = comp_n_limbs(u + n, d, n) >= 0;
+
+		if(qh){
+			sub_limbs(u + n, u + n, n, d, n);
+		}
+
+		if(n == 1){
+			q[0] = div_2by1_limbs(&u[0], u[1], u[0], d[0], reciprocal_word(d[0]));
+		}else {
+			divrem_limbs(q, u, 2 * n, d, n);
+		}
+
+		return qh;
+	}
+
+	int lo = n / 2;
+	int hi = n - lo;
+
+	uint64_t qh = dc_div_n_limbs(q + lo, u + 2 * lo, d + lo, hi, tp);
+
+	mul_limbs(tp, q + lo, hi, d, lo);
+
+	uint64_t cy = sub_limbs(u + lo, u + lo, n, tp, n);
+	if(qh){
+		cy += sub_limbs(u + n, u + n, lo, d, lo);
+	}
+
+	while(cy){
+		qh -= sub_limbs(q + lo, q + lo, hi, one_bn.digits, 1);
+		cy -= add_limbs(u + lo, u + lo, n, d, n);
+	}
+
+	uint64_t ql = dc_div_n_limbs(q, u + hi, d + hi, lo, tp);
+
+	mul_limbs(tp, d, hi, q, lo);
+
+	cy = sub_limbs(u, u, n, tp, n);
+	if(ql){
+		cy += sub_limbs(u + lo, u + lo, hi, d, hi);
+	}
+
+	while(cy){
+		sub_limbs(q, q, lo, one_bn.digits, 1);
+		cy -= add_limbs(u, u, n, d, n);
+	}
+
+	return qh;
+}
+
+/*  Divides a limb array by a normalized divisor with the Burnikel-Ziegler 
+ *  method, producing the quotient in blocks of dn limbs from the top. A 
+ *  block shorter than the divisor is estimated from the top limbs of the 
+ *  divisor only and then corrected. Same contract as divrem_limbs.
+ *
+ *  Input: quotient array of un - dn limbs, dividend limb array whose top 
+ *         limb is below the top limb of the divisor, its size, divisor 
+ *         limb array with the most significant bit set, its size
+ *  Output:
+ * 
+ */
+static void dc_divrem_limbs(uint64_t *q, uint64_t *u, int un, const uint64_t *d, int dn){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *scratch = get_ctx_bn(ctx);
+	reserve_bn(scratch, dn);
+
+	uint64_t *tp = scratch->digits;
+
+	int qn = un - dn;
+	int k = qn % dn == 0 ? dn : qn % dn;
+
+	for(int j = qn - k; j >= 0; j -= dn, k = dn){
+		uint64_t *w = u + j;
+
+		if(k == dn){
+			dc_div_n_limbs(q + j, w, d, dn, tp);
+			continue;
+		}
+
+		/* the top 2k limbs over the top k limbs of the divisor give the 
+		   block or a slight overestimate of it */
+		uint64_t qh = dc_div_n_limbs(q + j, w + dn - k, d + dn - k, k, tp);
+
+		if(k > dn - k){
+			mul_limbs(tp, q + j, k, d, dn - k);
+		}else {
+			mul_limbs(tp, d, dn - k, q + j, k);
+		}
+
+		uint64_t cy = sub_limbs(w, w, dn, tp, dn);
+		if(qh){
+			cy += sub_limbs(w + k, w + k, dn - k, d, dn - k);
+		}
+
+		while(cy){
+			qh -= sub_limbs(q + j, q + j, k, one_bn.digits, 1);
+			cy -= add_limbs(w, w, dn, d, dn);
+		}
+	}
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Montgomery reduction of a limb array of 2n limbs below m * R, with 
+ *  R = 2^(64n). Each step adds the multiple of m that clears the lowest 
+ *  limb, whose carry is parked in that limb and added at the end. t is 
+ *  destroyed and r must not overlap it.
+ *
+ *  Input: result array of n limbs, limb array of 2n limbs, odd modulus 
+ *         limb array, its size, -m^-1 mod 2^64
+ *  Output:
+ * 
+ */
+static void redc_limbs(uint64_t *r, uint64_t *t, const uint64_t *m, int n, uint64_t minv){
+	for(int i = 0; i < n; i++){
+		t[i] = addmul_1_limbs(t + i, m, n, t[i] * minv);
+	}
+
+	uint64_t carry = add_limbs(r, t + n, n, t, n);
+
+	if(carry || comp_n_limbs(r, m, n) >= 0){
+		sub_limbs(r, r, n, m, n);
+	}
+}
+
+/*  Greatest common divisor of two words with the binary method
+ *
+ *  Input: two words
+ *  Output: their greatest common divisor
+ * 
+ */
+static uint64_t gcd_word(uint64_t a, uint64_t b){
+	if(a == 0 || b == 0){
+		return a | b;
+	}
+
+	int k = __builtin_ctzll(a | b);
+	a >>= __builtin_ctzll(a);
+
+	while(b != 0){
+		b >>= __builtin_ctzll(b);
+
+		if(a > b){
+			uint64_t t = a;
+			a = b;
+			b = t;
+		}
+		b -= a;
+	}
+
+	return a << k;
+}
+
+/*  Removes the trailing zero bits of a nonzero limb array in place
+ *
+ *  Input: limb array, its size
+ *  Output: the new normalized size
+ * 
+ */
+static int strip_zeros_limbs(uint64_t *a, int n){
+	int z = 0;
+
+	while(a[z] == 0){
+		z++;
+	}
+
+	if(z){
+		memmove(a, a + z, (n - z) * sizeof(uint64_t));
+		n -= z;
+	}
+
+	rshift_limbs(a, a, n, __builtin_ctzll(a[0]));
+
+	while(a[n - 1] == 0){
+		n--;
+	}
+
+	return n;
+}
+
+/*  Greatest common divisor of two odd limb arrays with the binary method, 
+ *  which replaces the larger by the difference without its trailing zeros 
+ *  until both fit in a limb. Both arrays are overwritten.
+ *
+ *  Input: first odd limb array and its size, second odd limb array and 
+ *         its size
+ *  Output: the size of the divisor, which is left in the first array
+ * 
+ */
+static int gcd_binary_limbs(uint64_t *a, int an, uint64_t *b, int bn){
+	while(an > 1 || bn > 1){
+		int c = comp_limbs(a, an, b, bn);
+
+		if(c == 0){
+			return an;
+		}
+
+		if(c > 0){
+			sub_limbs(a, a, an, b, bn);
+			an = strip_zeros_limbs(a, an);
+
+		}else {
+			sub_limbs(b, b, bn, a, an);
+			bn = strip_zeros_limbs(b, bn);
+		}
+	}
+
+	a[0] = gcd_word(a[0], b[0]);
+	return 1;
+}
+
+/*  Simulates Euclidean steps on the leading 62 bits of a >= b with 
+ *  Knuth's Algorithm L, stopping as soon as a quotient is not certain. 
+ *  The steps taken map (a, b) to (A a + B b, C a + D b).
+ *
+ *  Input: first limb array and its size, second limb array and its size, 
+ *         array for the cofactors A, B, C and D
+ *  Output:
+ * 
+ */
+static void lehmer_word(const uint64_t *a, int n, const uint64_t *b, int bn, int64_t *m){
+	int s = __builtin_clzll(a[n - 1]);
+	uint64_t b1 = n - 1 < bn ? b[n - 1] : 0;
+	uint64_t b0 = n > 1 && n - 2 < bn ? b[n - 2] : 0;
+
+	uint64_t ah = a[n - 1] << s;
+	uint64_t bh = b1 << s;
+
+	if(s && n > 1){
+		ah |= a[n - 2] >> (64 - s);
+		bh |= b0 >> (64 - s);
+	}
+
+	int64_t x = (int64_t)(ah >> 2), y = (int64_t)(bh >> 2);
+	int64_t A = 1, B = 0, C = 0, D = 1;
+
+	while(y + C != 0 && y + D != 0){
+		int64_t q = (x + A) / (y + C);
+
+		if(q != (x + B) / (y + D)){
+			break;
+		}
+
+		int64_t t;
+		t = A - q * C; A = C; C = t;
+		t = B - q * D; B = D; D = t;
+		t = x - q * y; x = y; y = t;
+	}
+
+	m[0] = A;
+	m[1] = B;
+	m[2] = C;
+	m[3] = D;
+}
+
+/*  Computes x a + y b for cofactors of opposite signs when the result is 
+ *  known to fit in n limbs
+ *
+ *  Input: result array of n limbs, two limb arrays of n limbs, their size, 
+ *         the two cofactors
+ *  Output:
+ * 
+ */
+static void lincomb_limbs(uint64_t *r, const uint64_t *a, const uint64_t *b, int n, int64_t x, int64_t y){
+	if(x >= 0 && y <= 0){
+		mul_1_limbs(r, a, n, (uint64_t)x);
+		submul_1_limbs(r, b, n, -(uint64_t)y);
+
+	}else {
+		mul_1_limbs(r, b, n, (uint64_t)y);
+		submul_1_limbs(r, a, n, -(uint64_t)x);
+	}
+}
+
+/*  Writes a big number as n limbs in two's complement, n > x->size
+ *
+ *  Input: result array, a big number pointer, number of limbs
+ *  Output:
+ * 
+ */
+static void twos_limbs(uint64_t *r, BIGNUM *x, int n){
+	if(x->size > 0){
+		memcpy(r, x->digits, x->size * sizeof(uint64_t));
+	}
+	memset(r + x->size, 0, (n - x->size) * sizeof(uint64_t));
+
+	if(x->sign == 0){
+		/* -x = ~(x - 1) */
+		sub_limbs(r, r, n, one_bn.digits, 1);
+
+		for(int i = 0; i < n; i++){
+			r[i] = ~r[i];
+		}
+	}
+}
+
+/*  Bitwise and, or or xor of two big numbers with the semantics of 
+ *  infinite two's complement, shared by and_bn, or_bn and xor_bn
+ *
+ *  Input: two big numbers pointer, the operation ('&', '|' or '^'), a 
+ *         big number pointer
+ *  Output:
+ * 
+ */
+static void bitwise_bn(BIGNUM *x, BIGNUM *y, char op, BIGNUM *result){
+	int n = max(x->size, y->size) + 1;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *t = get_ctx_bn(ctx);
+	resize_bn(t, 2 * n);
+
+	uint64_t *a = t->digits, *b = t->digits + n;
+
+	twos_limbs(a, x, n);
+	twos_limbs(b, y, n);
+
+	for(int i = 0; i < n; i++){
+		a[i] = op == '&' ? a[i] & b[i] : op == '|' ? a[i] | b[i] : a[i] ^ b[i];
+	}
+
+	/* a negative result is stored back as its magnitude ~r + 1 */
+	uint8_t negative = a[n - 1] >> 63;
+
+	if(negative){
+		for(int i = 0; i < n; i++){
+			a[i] = ~a[i];
+		}
+		add_limbs(a, a, n, one_bn.digits, 1);
+	}
+
+	resize_bn(result, n);
+	memcpy(result->digits, a, n * sizeof(uint64_t));
+	result->sign = !negative;
+	rmzero_bn(result);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Adds or subtracts the magnitudes of two big numbers according to the
+ *  signs, shared by sum_bn and sub_bn
+ *
+ *  Input: a big number pointer, a big number pointer, the sign to be
+ *         used for the second number, a big number pointer
+ *  Output:
+ * 
+ */
+static void add_signed_bn(BIGNUM *x, BIGNUM *y, uint8_t ysign, BIGNUM *result){
+	uint8_t xsign = x->sign;
+
+	if(x->size < y->size){
+		BIGNUM *t = x; x = y; y = t;
+		uint8_t s = xsign; xsign = ysign; ysign = s;
+	}
+
+	int size  = x->size;
+	uint8_t sign = xsign;
+
+	reserve_bn(result, size + 1);
+
+	if(xsign == ysign){
+		result->digits[size] = add_limbs(result->digits, x->digits, x->size, y->digits, y->size);
+		size++;
+
+	}else if(comp_limbs(x->digits, x->size, y->digits, y->size) != -1){
+		sub_limbs(result->digits, x->digits, x->size, y->digits, y->size);
+
+	}else {
+		sub_limbs(result->digits, y->digits, y->size, x->digits, x->size);
+		sign = ysign;
+	}
+
+	result->size = size;
+	result->sign = sign;
+	rmzero_bn(result);
+}
+
+static void set_barrett_bn(BN_BARRETT *barrett, BIGNUM *m);
+static void divmod_barrett_bn(BIGNUM *x, BN_BARRETT *barrett, BIGNUM *quotient, BIGNUM *remainder);
+
+/*  Frees the decimal powers of a thread
+ *
+ *  Input: the powers
+ *  Output:
+ * 
+ */
+static void free_dec_powers_bn(void *powers){
+	BN_DEC_POWERS *p = (BN_DEC_POWERS*)powers;
+
+	if(p == dec_powers){
+		dec_powers = NULL;
+	}
+
+	for(int i = 0; i < p->count; i++){
+		free_barrett_bn(p->pw[i]);
+	}
+
+	free(p);
+}
+
+/*  Creates the key whose destructor frees the decimal powers
+ *
+ *  Input:
+ *  Output:
+ * 
+ */
+static void make_dec_powers_key(void){
+	dec_powers_key_ready = pthread_key_create(&dec_powers_key, free_dec_powers_bn) == 0;
+}
+
+/*  Returns the decimal powers of the calling thread with pw[i] = 
+ *  10^(19 2^i), squaring the last one until it has more than n limbs or 
+ *  count powers exist. With reciprocals set the Barrett reciprocals of 
+ *  those powers are filled too.
+ *
+ *  Input: size in limbs to exceed, maximum number of powers, whether 
+ *         the reciprocals are needed
+ *  Output: the powers, to be released with leave_dec_powers_bn
+ * 
+ */
+static BN_DEC_POWERS* enter_dec_powers_bn(int n, int count, int reciprocals){
+	BN_DEC_POWERS *p = dec_powers;
+
+	if(p == NULL){
+		p = (BN_DEC_POWERS*)malloc(sizeof(BN_DEC_POWERS));
+		p->count = 0;
+
+		pthread_once(&dec_powers_once, make_dec_powers_key);
+
+		if(dec_powers_key_ready && pthread_setspecific(dec_powers_key, p) == 0){
+			dec_powers = p;
+		}
+	}
+
+	while(p->count == 0 || (p->count < count && p->pw[p->count - 1]->m->size <= n)){
+		BN_BARRETT *b = (BN_BARRETT*)malloc(sizeof(BN_BARRETT));
+		b->m  = init_bn();
+		b->mu = init_bn();
+
+		if(p->count == 0){
+			set_word_bn(b->m, DEC_CHUNK_BASE);
+		}else {
+			sqr_bn(p->pw[p->count - 1]->m, b->m);
+		}
+
+		p->pw[p->count++] = b;
+	}
+
+	for(int i = 0; reciprocals && i < p->count; i++){
+		if(p->pw[i]->mu->size == 0){
+			set_barrett_bn(p->pw[i], p->pw[i]->m);
+		}
+		if(p->pw[i]->m->size > n){
+			break;
+		}
+	}
+
+	return p;
+}
+
+/*  Releases the powers returned by enter_dec_powers_bn, freeing them if 
+ *  they could not be kept for the thread
+ *
+ *  Input: the powers
+ *  Output:
+ * 
+ */
+static void leave_dec_powers_bn(BN_DEC_POWERS *powers){
+	if(powers != dec_powers){
+		free_dec_powers_bn(powers);
+	}
+}
+
+/*  Writes the magnitude of a big number as exactly width decimal digits, 
+ *  zero padded, with one single limb division per 19 digits
+ *
+ *  Input: a big number pointer, output buffer, number of digits, a 
+ *         multiple of DEC_CHUNK_DIGITS large enough for the number
+ *  Output:
+ * 
+ */
+static void to_dec_basecase_bn(BIGNUM *x, char *out, size_t width){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *t = get_ctx_bn(ctx);
+	copy_bn(t, x);
+
+	int n = t->size;
+
+	for(char *p = out + width; p > out;){
+		uint64_t c = 0;
+
+		if(n > 0){
+			c = divmod_1_limbs(t->digits, t->digits, n, DEC_CHUNK_BASE);
+			while(n > 0 && t->digits[n - 1] == 0){
+				n--;
+			}
+		}
+
+		for(int j = 0; j < DEC_CHUNK_DIGITS / 2; j++){
+			p -= 2;
+			memcpy(p, dec_pairs + 2 * (c % 100), 2);
+			c /= 100;
+		}
+		*--p = '0' + c;
+	}
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Writes x < 10^width as exactly width decimal digits, splitting it into 
+ *  the quotient and remainder by pw[k] = 10^(width / 2), divided with 
+ *  its Barrett reciprocal, until the pieces are small enough for the 
+ *  basecase
+ *
+ *  Input: a nonnegative big number pointer, powers of ten, index of the 
+ *         splitting power, output buffer, number of digits
+ *  Output:
+ * 
+ */
+static void to_dec_rec_bn(BIGNUM *x, BN_BARRETT **pw, int k, char *out, size_t width){
+	if(x->size < DEC_DC_THRESHOLD || k < 0){
+		to_dec_basecase_bn(x, out, width);
+		return;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *q = get_ctx_bn(ctx);
+	BIGNUM *r = get_ctx_bn(ctx);
+
+	divmod_barrett_bn(x, pw[k], q, r);
+
+	to_dec_rec_bn(q, pw, k - 1, out, width / 2);
+	to_dec_rec_bn(r, pw, k - 1, out + width / 2, width / 2);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Writes a nonnegative big number as decimal digits without leading 
+ *  zeros. While it is large the low 19 2^k digits are split off by the 
+ *  largest power pw[k] <= x, which keeps x < pw[k]^2 for the Barrett 
+ *  division, and written by to_dec_rec_bn behind the digits of the 
+ *  quotient.
+ *
+ *  Input: a nonnegative big number pointer, powers of ten, index of the 
+ *         largest power with x < pw[k]^2 or -1, output buffer, its size
+ *  Output: the number of digits, 0 if they do not fit
+ * 
+ */
+static size_t to_dec_top_bn(BIGNUM *x, BN_BARRETT **pw, int k, char *out, size_t size){
+	int n = x->size / 2 + 1;
+
+	while(k > 0 && (pw[k - 1]->m->size > n || comp_limbs(pw[k]->m->digits, pw[k]->m->size, x->digits, x->size) == 1)){
+		k--;
+	}
+
+	if(x->size < DEC_DC_THRESHOLD || k < 0 || comp_limbs(pw[k]->m->digits, pw[k]->m->size, x->digits, x->size) == 1){
+		/* a limb holds less than 19.3 digits */
+		char digits[DEC_CHUNK_DIGITS * (DEC_DC_THRESHOLD + DEC_DC_THRESHOLD / 64 + 2)];
+		size_t width = DEC_CHUNK_DIGITS * (size_t)(x->size + x->size / 64 + 1);
+
+		to_dec_basecase_bn(x, digits, width);
+
+		size_t lead = 0;
+		while(lead < width - 1 && digits[lead] == '0'){
+			lead++;
+		}
+
+		if(width - lead > size){
+			return 0;
+		}
+
+		memcpy(out, digits + lead, width - lead);
+		return width - lead;
+	}
+
+	size_t width = (size_t)DEC_CHUNK_DIGITS << k;
+
+	if(width >= size){
+		return 0;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *q = get_ctx_bn(ctx);
+	BIGNUM *r = get_ctx_bn(ctx);
+
+	divmod_barrett_bn(x, pw[k], q, r);
+
+	size_t len = to_dec_top_bn(q, pw, k - 1, out, size - width);
+	if(len > 0){
+		to_dec_rec_bn(r, pw, k - 1, out + len, width);
+		len += width;
+	}
+
+	leave_ctx_bn(ctx);
+
+	return len;
+}
+
+/*  Writes the decimal string of a big number with its terminating null 
+ *  into a buffer of the given size, with a leading '-' for negative 
+ *  numbers. Large numbers are split recursively by the tree of powers 
+ *  10^(19 2^k) cached for the thread. Nothing past size bytes is 
+ *  touched, and str_size_bn bytes always suffice.
+ *
+ *  Input: a big number pointer, output buffer, its size
+ *  Output: the length of the string, 0 if it does not fit
+ * 
+ */
+static size_t to_dec_bn(BIGNUM *num, char *out, size_t size){
+	size_t sign = num->sign == 0;
+
+	/* the sign, a digit and the null */
+	if(size < sign + 2){
+		return 0;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *x = get_ctx_bn(ctx);
+	BN_DEC_POWERS *powers = NULL;
+
+	copy_bn(x, num);
+	x->sign = 1;
+
+	int k = -1;
+
+	if(x->size >= DEC_DC_THRESHOLD){
+		/* x < pw[k]^2, which needs 2 size(pw[k]) - 2 >= size(x) */
+		int n = x->size / 2 + 1;
+
+		powers = enter_dec_powers_bn(n, 32, 1);
+		k = 0;
+		while(k < powers->count - 1 && powers->pw[k]->m->size <= n){
+			k++;
+		}
+	}
+
+	size_t len = to_dec_top_bn(x, powers != NULL ? powers->pw : NULL, k, out + sign, size - sign - 1);
+
+	if(powers != NULL){
+		leave_dec_powers_bn(powers);
+	}
+
+	leave_ctx_bn(ctx);
+
+	if(len == 0){
+		return 0;
+	}
+
+	if(sign){
+		out[0] = '-';
+	}
+
+	len += sign;
+	out[len] = 0;
+
+	return len;
+}
+
+/*  Writes a whole buffer to a file descriptor, looping over partial 
+ *  writes and interrupted calls
+ *
+ *  Input: a file descriptor, the buffer, its size in bytes
+ *  Output: 0 on success, -1 on error
+ * 
+ */
+static int write_all(int fd, const void *buf, size_t len){
+	const char *p = buf;
+
+	while(len > 0){
+		ssize_t w = write(fd, p, len);
+
+		if(w < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+
+		p   += w;
+		len -= w;
+	}
+
+	return 0;
+}
+
+/*  Reads a string of decimal digits with the quadratic chunk loop, 19 
+ *  digits per single limb multiply
+ *
+ *  Input: the digits, their count, a big number pointer
+ *  Output:
+ * 
+ */
+static void from_dec_basecase_bn(const char *num, int size, BIGNUM *result){
+	resize_bn(result, size / DEC_CHUNK_DIGITS + 1);
+	result->sign = 1;
+	int n = 0;
+
+	for(int i = 0; i < size;){
+		int len = (size - i) % DEC_CHUNK_DIGITS;
+		if(len == 0){
+			len = DEC_CHUNK_DIGITS;
+		}
+
+		uint64_t chunk = 0, base = 1;
+		for(int j = 0; j < len; j++, i++){
+			chunk = chunk * 10 + (num[i] - 48);
+			base *= 10;
+		}
+
+		uint64_t carry = chunk;
+		for(int j = 0; j < n; j++){
+			uint128_t p = (uint128_t)result->digits[j] * base + carry;
+			result->digits[j] = (uint64_t)p;
+			carry = (uint64_t)(p >> 64);
+		}
+		if(carry){
+			result->digits[n++] = carry;
+		}
+	}
+
+	result->size = n;
+	rmzero_bn(result);
+}
+
+/*  Reads a string of decimal digits as hi 10^w + lo, where the low part 
+ *  has w = 19 2^k digits and at least half of them, until the pieces are 
+ *  small enough for the basecase
+ *
+ *  Input: the digits, their count, powers of ten, index of the largest 
+ *         usable power, a big number pointer
+ *  Output:
+ * 
+ */
+static void from_dec_rec_bn(const char *num, int size, BN_BARRETT **pw, int k, BIGNUM *result){
+	while(k >= 0 && ((size_t)DEC_CHUNK_DIGITS << k) >= (size_t)size){
+		k--;
+	}
+
+	if(size <= DEC_DC_THRESHOLD * DEC_CHUNK_DIGITS || k < 0){
+		from_dec_basecase_bn(num, size, result);
+		return;
+	}
+
+	int w = DEC_CHUNK_DIGITS << k;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *hi = get_ctx_bn(ctx);
+	BIGNUM *lo = get_ctx_bn(ctx);
+
+	from_dec_rec_bn(num, size - w, pw, k, hi);
+	from_dec_rec_bn(num + size - w, w, pw, k - 1, lo);
+
+	mul_bn(hi, pw[k]->m, result);
+	sum_bn(result, lo, result);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Fills a Montgomery context whose numbers are already allocated, so 
+ *  that pow_mod_bn can build one from context temporaries
+ *
+ *  Input: a Montgomery context pointer, odd modulus in big number format
+ *  Output:
+ * 
+ */
+static void set_mont_bn(BN_MONT *mont, BIGNUM *m){
+	int n = m->size;
+
+	copy_bn(mont->n, m);
+	mont->n->sign = 1;
+	mont->ninv = neg_inverse_word(m->digits[0]);
+
+	/* R^2 = 2^(128n) */
+	resize_bn(mont->rr, 2 * n + 1);
+	memset(mont->rr->digits, 0, 2 * n * sizeof(uint64_t));
+	mont->rr->digits[2 * n] = 1;
+	mont->rr->sign = 1;
+
+	mod_bn(mont->rr, mont->n, mont->rr);
+}
+
+/*  Fills a Barrett context whose numbers are already allocated, so that 
+ *  pow_mod_bn can build one from context temporaries
+ *
+ *  Input: a Barrett context pointer, modulus in big number format
+ *  Output:
+ * 
+ */
+static void set_barrett_bn(BN_BARRETT *barrett, BIGNUM *m){
+	int k = m->size;
+
+	copy_bn(barrett->m, m);
+	barrett->m->sign = 1;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	/* mu = floor(2^(128k) / m), k + 1 limbs */
+	BIGNUM *t = get_ctx_bn(ctx);
+	resize_bn(t, 2 * k + 1);
+	memset(t->digits, 0, 2 * k * sizeof(uint64_t));
+	t->digits[2 * k] = 1;
+	t->sign = 1;
+
+	div_bn(t, barrett->m, barrett->mu);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Window size of the sliding window exponentiation for an exponent of 
+ *  the given length, balancing the 2^(k-1) table entries against the 
+ *  multiplications saved
+ *
+ *  Input: exponent length in bits
+ *  Output: window size in bits
+ * 
+ */
+static int window_bits(int bits){
+	if(bits > 671){
+		return 6;
+	}
+	if(bits > 239){
+		return 5;
+	}
+	if(bits > 79){
+		return 4;
+	}
+	if(bits > 23){
+		return 3;
+	}
+
+	return 1;
+}
+
+/*	Reduction used by the exponentiations: a Montgomery context, a 
+ *	Barrett context, or neither for plain powers
+ */
+typedef struct {
+
+	BN_MONT *mont;
+	BN_BARRETT *barrett;
+
+}BN_REDUCER;
+
+/*  Multiplication step of the exponentiations: Montgomery multiplication, 
+ *  multiplication followed by a Barrett reduction or plain multiplication 
+ *  according to the reducer. Squares go through the same call with 
+ *  x == y.
+ *
+ *  Input: two big number pointers, a reducer, a big number pointer
+ *  Output:
+ * 
+ */
+static void exp_mul_bn(BIGNUM *x, BIGNUM *y, const BN_REDUCER *red, BIGNUM *result){
+	if(red->mont != NULL){
+		mul_mont_bn(x, y, red->mont, result);
+
+	}else if(red->barrett != NULL){
+		BN_CTX *ctx = enter_ctx_bn();
+
+		BIGNUM *t = get_ctx_bn(ctx);
+		mul_bn(x, y, t);
+		mod_barrett_bn(t, red->barrett, result);
+
+		leave_ctx_bn(ctx);
+
+	}else {
+		mul_bn(x, y, result);
+	}
+}
+
+/*  Left to right sliding window exponentiation. The odd powers b, b^3, 
+ *  ..., b^(2^k - 1) are tabulated and the exponent bits are read from the 
+ *  limbs, every run of up to k bits that starts and ends with a one 
+ *  costing one multiplication by a table entry. The sign of the exponent 
+ *  is ignored.
+ *
+ *  Input: base already in the form of the reducer (Montgomery form or 
+ *         reduced), exponent, a reducer, the number one in the form of 
+ *         the reducer, a big number pointer
+ *  Output:
+ * 
+ */
+static void pow_window_bn(BIGNUM *b, BIGNUM *e, const BN_REDUCER *red, BIGNUM *one, BIGNUM *result){
+	int bits = bit_length_bn(e);
+	int k = window_bits(bits);
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *table[32];
+	BIGNUM *r = get_ctx_bn(ctx);
+
+	table[0] = get_ctx_bn(ctx);
+	copy_bn(table[0], b);
+
+	if(k > 1){
+		BIGNUM *b2 = get_ctx_bn(ctx);
+		exp_mul_bn(b, b, red, b2);
+
+		for(int i = 1; i < 1 << (k - 1); i++){
+			table[i] = get_ctx_bn(ctx);
+			exp_mul_bn(table[i - 1], b2, red, table[i]);
+		}
+	}
+
+	int started = 0;
+
+	for(int i = bits - 1; i >= 0; ){
+		if(test_bit_bn(e, i) == 0){
+			exp_mul_bn(r, r, red, r);
+			i--;
+			continue;
+		}
+
+		/* longest window i..j of at most k bits ending in a one */
+		int j = i - k + 1 < 0 ? 0 : i - k + 1;
+		while(test_bit_bn(e, j) == 0){
+			j++;
+		}
+
+		int w = 0;
+		for(int l = i; l >= j; l--){
+			w = (w << 1) | test_bit_bn(e, l);
+		}
+
+		if(started){
+			for(int l = i; l >= j; l--){
+				exp_mul_bn(r, r, red, r);
+			}
+			exp_mul_bn(r, table[w >> 1], red, r);
+
+		}else {
+			copy_bn(r, table[w >> 1]);
+			started = 1;
+		}
+
+		i = j - 1;
+	}
+
+	if(!started){
+		copy_bn(r, one);
+	}
+
+	copy_bn(result, r);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Number of teeth of a comb for exponents of the given length, the 
+ *  table has 2^teeth entries and an exponentiation about 2 * bits / teeth 
+ *  multiplications
+ *
+ *  Input: exponent length in bits
+ *  Output: number of teeth
+ * 
+ */
+static int comb_teeth(int bits){
+	if(bits >= 512){
+		return 8;
+	}
+	if(bits >= 128){
+		return 6;
+	}
+
+	return 4;
+}
+
+/*  Writes a 64-bit word as eight little endian bytes
+ *
+ *  Input: destination buffer, the word
+ *  Output:
+ * 
+ */
+static void put_word(uint8_t *buf, uint64_t w){
+	for(int i = 0; i < 8; i++){
+		buf[i] = (uint8_t)(w >> (8 * i));
+	}
+}
+
+/*  Reads a 64-bit word stored as eight little endian bytes
+ *
+ *  Input: source buffer
+ *  Output: the word
+ * 
+ */
+static uint64_t get_word(const uint8_t *buf){
+	uint64_t w = 0;
+
+	for(int i = 0; i < 8; i++){
+		w |= (uint64_t)buf[i] << (8 * i);
+	}
+
+	return w;
+}
+
+/*  Allocates a comb for a modulus and fills its reducer, leaving the base 
+ *  and the table to the caller
+ *
+ *  Input: modulus in big number format, number of teeth, spacing
+ *  Output: pointer to the comb
+ * 
+ */
+static BN_COMB* alloc_comb_bn(BIGNUM *m, int teeth, int spacing){
+	BN_COMB *comb = (BN_COMB*)malloc(sizeof(BN_COMB));
+
+	comb->g = init_bn();
+	comb->m = init_bn();
+	copy_bn(comb->m, m);
+	comb->m->sign = 1;
+
+	comb->mont    = NULL;
+	comb->barrett = NULL;
+
+	if(m->digits[0] & 1){
+		comb->mont = init_mont_bn(comb->m);
+	}else {
+		comb->barrett = init_barrett_bn(comb->m);
+	}
+
+	comb->teeth   = teeth;
+	comb->spacing = spacing;
+	comb->table   = (BIGNUM**)malloc(((size_t)1 << teeth) * sizeof(BIGNUM*));
+
+	for(int i = 0; i < 1 << teeth; i++){
+		comb->table[i] = init_bn();
+	}
+
+	return comb;
+}
+
+/*	One half of a CRT exponentiation, the argument of crt_half_bn
+ */
+typedef struct {
+
+	BIGNUM *x;
+	BIGNUM *e;
+	BN_MONT *mont;
+	BIGNUM *result;
+
+}BN_CRT_HALF;
+
+/*  Runs one half of a CRT exponentiation, x^e modulo one of the primes. 
+ *  It can run on its own thread, whose temporaries then come from the 
+ *  default context of that thread since the bound context is per thread.
+ *
+ *  Input: pointer to a BN_CRT_HALF
+ *  Output: NULL
+ * 
+ */
+static void* crt_half_bn(void *arg){
+	BN_CRT_HALF *half = (BN_CRT_HALF*)arg;
+
+	pow_mod_mont_bn(half->x, half->e, half->mont, half->result);
+
+	return NULL;
+}
+
+/*  Writes the 16 byte header of a binary container: the magic "BNLB", 
+ *  the format version and the number of big numbers
+ *
+ *  Input: destination buffer, number of big numbers
+ *  Output:
+ * 
+ */
+static void put_container_header(uint8_t *buf, int count){
+	memcpy(buf, "BNLB", 4);
+
+	for(int j = 0; j < 4; j++){
+		buf[4 + j] = (uint8_t)(BN_FORMAT_VERSION >> (8 * j));
+	}
+
+	put_word(buf + 8, (uint64_t)count);
+}
+
+/*  Checks the header of a binary container and that the limbs of every 
+ *  number lie inside it with a nonzero top limb, shared by deserialize_bn 
+ *  and map_bn
+ *
+ *  Input: the container, its size in bytes
+ *  Output: the number of big numbers it holds, -1 if it is malformed
+ * 
+ */
+static int check_container_bn(const uint8_t *buf, size_t size){
+	if(size < 16 || memcmp(buf, "BNLB", 4) != 0){
+		return -1;
+	}
+
+	uint32_t version = 0;
+	for(int j = 0; j < 4; j++){
+		version |= (uint32_t)buf[4 + j] << (8 * j);
+	}
+
+	uint64_t count = get_word(buf + 8);
+
+	if(version != BN_FORMAT_VERSION || count > INT32_MAX || count > (size - 16) / 16){
+		return -1;
+	}
+
+	size_t needed = 16 + 16 * count;
+	const uint8_t *e = buf + 16;
+
+	for(uint64_t i = 0; i < count; i++, e += 16){
+		uint64_t n = get_word(e);
+
+		if(n > INT32_MAX || get_word(e + 8) > 1 || n > (size - needed) / 8){
+			return -1;
+		}
+
+		/* the limbs of the number start at buf + needed */
+		if(n > 0 && get_word(buf + needed + (n - 1) * 8) == 0){
+			return -1;
+		}
+		needed += n * 8;
+	}
+
+	return (int)count;
+}
+
+/*	Initializes the number values ​​and returns a big number pointer
+ *
+ *  Input:
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* init_bn(){
+
+	BIGNUM *num = malloc(sizeof(BIGNUM));
+	num->digits   = num->small;
+	num->size     = 0;
+	num->capacity = BN_INLINE_LIMBS;
+	num->sign     = 1;
+	num->borrowed = 0;
+
+	return num;
+
+}
+
+/*	Converts a big number to an integer, keeping only the low bits of 
+ *	numbers out of range; bn_to_int64 reports the overflow instead
+ *
+ *  Input: a big number pointer
+ *  Output: an integer
+ * 
+ */
+int bn_to_int(BIGNUM *num){
+
+	uint64_t v = num->size > 0 ? num->digits[0] : 0;
+
+	if(num->sign == 0){
+		v = 0 - v;
+	}
+
+	return (int)(uint32_t)v;
+}
+
+/*	Converts an integer to a big number
+ *
+ *  Input: an integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* int_to_bn(int num){
+	return int64_to_bn(num);
+}
+
+/*	Converts a signed 64-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* int64_to_bn(int64_t num){
+	BIGNUM *bignum = init_bn();
+
+	set_word_bn(bignum, num < 0 ? -(uint64_t)num : (uint64_t)num);
+	bignum->sign = num >= 0;
+
+	return bignum;
+}
+
+/*	Converts an unsigned 64-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* uint64_to_bn(uint64_t num){
+	BIGNUM *bignum = init_bn();
+
+	set_word_bn(bignum, num);
+
+	return bignum;
+}
+
+/*	Converts a signed 128-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* int128_to_bn(__int128 num){
+	BIGNUM *bignum = init_bn();
+	uint128_t value = num < 0 ? -(uint128_t)num : (uint128_t)num;
+
+	resize_bn(bignum, 2);
+	bignum->digits[0] = (uint64_t)value;
+	bignum->digits[1] = (uint64_t)(value >> 64);
+	bignum->sign = num >= 0;
+
+	rmzero_bn(bignum);
+	return bignum;
+}
+
+/*	Converts a big number to a signed 64-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is out of range
+ * 
+ */
+int bn_to_int64(BIGNUM *num, int64_t *value){
+	uint64_t m = num->size > 0 ? num->digits[0] : 0;
+
+	if(num->size > 1 || m > (uint64_t)INT64_MAX + (num->sign == 0)){
+		return -1;
+	}
+
+	*value = num->sign ? (int64_t)m : (int64_t)(0 - m);
+	return 0;
+}
+
+/*	Converts a big number to an unsigned 64-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is negative or too large
+ * 
+ */
+int bn_to_uint64(BIGNUM *num, uint64_t *value){
+	if(num->size > 1 || (num->sign == 0 && num->size > 0)){
+		return -1;
+	}
+
+	*value = num->size > 0 ? num->digits[0] : 0;
+	return 0;
+}
+
+/*	Converts a big number to a signed 128-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is out of range
+ * 
+ */
+int bn_to_int128(BIGNUM *num, __int128 *value){
+	if(num->size > 2){
+		return -1;
+	}
+
+	uint128_t m = 0;
+
+	for(int i = num->size - 1; i >= 0; i--){
+		m = (m << 64) | num->digits[i];
+	}
+
+	uint128_t limit = ((uint128_t)1 << 127) - (num->sign != 0);
+
+	if(m > limit){
+		return -1;
+	}
+
+	*value = num->sign ? (__int128)m : (__int128)(0 - m);
+	return 0;
+}
+
+/*	Converts a string-like integer to a big number
+ *
+ *  Input: a string
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* str_to_bn(char num[], int size){
+	BIGNUM *bignum = init_bn();
+	int start = 0;
+
+	if(size > 0 && (num[0] == '-' || num[0] == '+')){
+		start = 1;
+	}
+
+	int len = size - start;
+
+	if(len <= DEC_DC_THRESHOLD * DEC_CHUNK_DIGITS){
+		from_dec_basecase_bn(num + start, len, bignum);
+
+	}else {
+		/* powers up to 10^(19 2^k) with 19 2^k < len, the first split */
+		int k = 0;
+		while(((size_t)DEC_CHUNK_DIGITS << (k + 1)) < (size_t)len){
+			k++;
+		}
+
+		BN_DEC_POWERS *powers = enter_dec_powers_bn(INT_MAX, k + 1, 0);
+		from_dec_rec_bn(num + start, len, powers->pw, k, bignum);
+		leave_dec_powers_bn(powers);
+	}
+
+	if(start && num[0] == '-' && bignum->size > 0){
+		bignum->sign = 0;
+	}
+
+	return bignum;
+}
+
+/*	Upper bound of the length of the decimal string of a big number, 
+ *	counting the sign and the terminating null
+ *
+ *  Input: a big number pointer
+ *  Output: the buffer size that bn_to_str always fits in
+ * 
+ */
+size_t str_size_bn(BIGNUM *num){
+	return DEC_CHUNK_DIGITS * (size_t)(num->size + num->size / 64 + 1) + 2;
+}
+
+/*	Converts a big number to a decimal string, with a leading '-' for 
+ *	negative numbers, which str_to_bn reads back. The string is rendered 
+ *	directly into buf when it fits in size bytes, otherwise NULL is 
+ *	returned and the contents of buf are unspecified; a NULL buf gets a 
+ *	newly allocated string of str_size_bn bytes to be released with free. 
+ *	Large numbers are converted by recursive division.
+ *
+ *  Input: a big number pointer, a buffer or NULL, size of the buffer
+ *  Output: the string, or NULL if it does not fit in buf
+ * 
+ */
+char* bn_to_str(BIGNUM *num, char *buf, size_t size){
+	if(buf == NULL){
+		size = str_size_bn(num);
+		buf  = (char*)malloc(size);
+
+		to_dec_bn(num, buf, size);
+		return buf;
+	}
+
+	return to_dec_bn(num, buf, size) > 0 ? buf : NULL;
+}
+
+/*	Writes the decimal string of a big number to a stream with a single 
+ *	fwrite
+ *
+ *  Input: a big number pointer, an output stream
+ *  Output: the number of characters written, -1 on error
+ * 
+ */
+int bn_write(BIGNUM *num, FILE *stream){
+	size_t size = str_size_bn(num);
+	char *str = (char*)malloc(size);
+	size_t len = to_dec_bn(num, str, size);
+
+	size_t written = fwrite(str, 1, len, stream);
+	free(str);
+
+	return written == len ? (int)len : -1;
+}
+
+/*	Writes the decimal string of a big number to a file descriptor, 
+ *	looping over partial writes and interrupted calls
+ *
+ *  Input: a big number pointer, a file descriptor
+ *  Output: the number of characters written, -1 on error
+ * 
+ */
+int bn_write_fd(BIGNUM *num, int fd){
+	size_t size = str_size_bn(num);
+	char *str = (char*)malloc(size);
+	size_t len = to_dec_bn(num, str, size);
+
+	int status = write_all(fd, str, len);
+	free(str);
+
+	return status == 0 ? (int)len : -1;
+}
+
+/*	Exports the magnitude of a big number as bytes, most significant 
+ *	first when big_endian is set and least significant first otherwise, 
+ *	like mpz_export with one byte words. Zero has no bytes. Nothing is 
+ *	written when buf is NULL or smaller than needed.
+ *
+ *  Input: a big number pointer, destination buffer or NULL, its size in 
+ *         bytes, the byte order
+ *  Output: number of bytes of the magnitude
+ * 
+ */
+size_t export_bn(BIGNUM *x, uint8_t *buf, size_t size, int big_endian){
+	size_t needed = (bit_length_bn(x) + 7) / 8;
+
+	if(buf == NULL || size < needed){
+		return needed;
+	}
+
+	for(size_t i = 0; i < needed; i++){
+		uint8_t byte = (uint8_t)(x->digits[i / 8] >> (8 * (i % 8)));
+		buf[big_endian ? needed - 1 - i : i] = byte;
+	}
+
+	return needed;
+}
+
+/*	Imports a nonnegative big number from bytes, most significant first 
+ *	when big_endian is set and least significant first otherwise, like 
+ *	mpz_import with one byte words
+ *
+ *  Input: source buffer, its size in bytes, the byte order, a big number 
+ *         pointer
+ *  Output:
+ * 
+ */
+void import_bn(const uint8_t *buf, size_t size, int big_endian, BIGNUM *result){
+	int n = (int)((size + 7) / 8);
+
+	resize_bn(result, n);
+	result->sign = 1;
+
+	if(n > 0){
+		memset(result->digits, 0, n * sizeof(uint64_t));
+	}
+
+	for(size_t i = 0; i < size; i++){
+		uint8_t byte = buf[big_endian ? size - 1 - i : i];
+		result->digits[i / 8] |= (uint64_t)byte << (8 * (i % 8));
+	}
+
+	rmzero_bn(result);
+}
+
+/*	Serializes many big numbers into the binary container read by 
+ *	deserialize_bn and map_bn. The layout, all little endian, is the 
+ *	magic "BNLB", the version as a 32-bit word and the count as a 64-bit 
+ *	word, then per number its size in limbs and its sign as 64-bit words, 
+ *	then the limbs of every number in order. The limbs start 8 byte 
+ *	aligned so that a mapped file can be used in place. Nothing is 
+ *	written when buf is NULL or smaller than needed.
+ *
+ *  Input: array of big numbers, its size, destination buffer or NULL, 
+ *         its size in bytes
+ *  Output: number of bytes of the container
+ * 
+ */
+size_t serialize_bn(BIGNUM **nums, int count, uint8_t *buf, size_t size){
+	size_t needed = 16 + 16 * (size_t)count;
+
+	for(int i = 0; i < count; i++){
+		needed += (size_t)nums[i]->size * 8;
+	}
+
+	if(buf == NULL || size < needed){
+		return needed;
+	}
+
+	put_container_header(buf, count);
+
+	uint8_t *w = buf + 16;
+
+	for(int i = 0; i < count; i++, w += 16){
+		put_word(w, (uint64_t)nums[i]->size);
+		put_word(w + 8, nums[i]->sign);
+	}
+
+	for(int i = 0; i < count; i++){
+		for(int j = 0; j < nums[i]->size; j++, w += 8){
+			put_word(w, nums[i]->digits[j]);
+		}
+	}
+
+	return needed;
+}
+
+/*	Streams the binary container of serialize_bn to a file descriptor 
+ *	without building it in memory, so that a checkpoint costs no more 
+ *	than the limbs themselves
+ *
+ *  Input: array of big numbers, its size, a file descriptor
+ *  Output: 0 on success, -1 on error
+ * 
+ */
+int serialize_fd_bn(BIGNUM **nums, int count, int fd){
+	uint8_t header[16];
+
+	put_container_header(header, count);
+
+	if(write_all(fd, header, 16) != 0){
+		return -1;
+	}
+
+	for(int i = 0; i < count; i++){
+		uint8_t entry[16];
+
+		put_word(entry, (uint64_t)nums[i]->size);
+		put_word(entry + 8, nums[i]->sign);
+
+		if(write_all(fd, entry, 16) != 0){
+			return -1;
+		}
+	}
+
+	for(int i = 0; i < count; i++){
+		int n = nums[i]->size;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		if(n > 0 && write_all(fd, nums[i]->digits, (size_t)n * 8) != 0){
+			return -1;
+		}
+#else
+		uint8_t limb[8];
+
+		for(int j = 0; j < n; j++){
+			put_word(limb, nums[i]->digits[j]);
+
+			if(write_all(fd, limb, 8) != 0){
+				return -1;
+			}
+		}
+#endif
+	}
+
+	return 0;
+}
+
+/*	Loads the big numbers of a binary container written by serialize_bn 
+ *	into count big numbers, copying their limbs
+ *
+ *  Input: the container, its size in bytes, array of big number 
+ *         pointers or NULL, its size
+ *  Output: the number of big numbers in the container, -1 if it is 
+ *          malformed
+ * 
+ */
+int deserialize_bn(const uint8_t *buf, size_t size, BIGNUM **nums, int count){
+	int total = check_container_bn(buf, size);
+
+	if(total < 0 || nums == NULL){
+		return total;
+	}
+
+	const uint8_t *e = buf + 16;
+	const uint8_t *w = buf + 16 + 16 * (size_t)total;
+
+	for(int i = 0; i < total && i < count; i++, e += 16){
+		int n = (int)get_word(e);
+
+		resize_bn(nums[i], n);
+		nums[i]->sign = (uint8_t)get_word(e + 8);
+
+		for(int j = 0; j < n; j++, w += 8){
+			nums[i]->digits[j] = get_word(w);
+		}
+		rmzero_bn(nums[i]);
+	}
+
+	return total;
+}
+
+/*	Wraps the big numbers of a binary container written by serialize_bn, 
+ *	typically a mapped file, without copying: their limbs point into buf, 
+ *	which must outlive them. Such numbers are read only operands; one 
+ *	used as a result first gets limbs of its own. When the container is 
+ *	not 8 byte aligned or the host is big endian the limbs are copied.
+ *
+ *  Input: the container, its size in bytes, array of big number 
+ *         pointers or NULL, its size
+ *  Output: the number of big numbers in the container, -1 if it is 
+ *          malformed
+ * 
+ */
+int map_bn(const uint8_t *buf, size_t size, BIGNUM **nums, int count){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	int total = check_container_bn(buf, size);
+
+	if(total < 0 || nums == NULL || ((uintptr_t)buf & 7) != 0){
+		return deserialize_bn(buf, size, nums, count);
+	}
+
+	const uint8_t *e = buf + 16;
+	const uint64_t *w = (const uint64_t*)(buf + 16 + 16 * (size_t)total);
+
+	for(int i = 0; i < total && i < count; i++, e += 16){
+		int n = (int)get_word(e);
+
+		free_digits_bn(nums[i]);
+
+		nums[i]->digits   = (uint64_t*)w;
+		nums[i]->size     = n;
+		nums[i]->capacity = 0;
+		nums[i]->borrowed = 1;
+		nums[i]->sign     = (uint8_t)get_word(e + 8);
+		w += n;
+
+		rmzero_bn(nums[i]);
+	}
+
+	return total;
+#else
+	return deserialize_bn(buf, size, nums, count);
+#endif
+}
+
+/*	Calculates the bit size of a large number from its top limb
+ *
+ *  Input: a big number
+ *  Output: an integer containing the length in bits
+ * 
+ */
+int bit_length_bn(BIGNUM *xx){
+	if(xx->size == 0){
+		return 0;
+	}
+
+	return xx->size * 64 - __builtin_clzll(xx->digits[xx->size - 1]);
+}
+
+/*  Shifts a big number left, multiplying it by 2^bits. The result may 
+ *  alias x.
+ *
+ *  Input: a big number pointer, the shift in bits, a big number pointer
+ *  Output:
+ * 
+ */
+void lshift_bn(BIGNUM *x, int bits, BIGNUM *result){
+	int n = x->size, w = bits / 64;
+
+	if(n == 0){
+		result->size = 0;
+		result->sign = 1;
+		return;
+	}
+
+	uint8_t sign = x->sign;
+
+	reserve_bn(result, n + w + 1);
+	result->digits[n + w] = lshift_limbs(result->digits + w, x->digits, n, bits % 64);
+	memset(result->digits, 0, w * sizeof(uint64_t));
+
+	result->size = n + w + 1;
+	result->sign = sign;
+	rmzero_bn(result);
+}
+
+/*  Shifts the magnitude of a big number right, which truncates toward 
+ *  zero like div_bn by 2^bits. The result may alias x.
+ *
+ *  Input: a big number pointer, the shift in bits, a big number pointer
+ *  Output:
+ * 
+ */
+void rshift_bn(BIGNUM *x, int bits, BIGNUM *result){
+	int n = x->size, w = bits / 64;
+
+	if(w >= n){
+		result->size = 0;
+		result->sign = 1;
+		return;
+	}
+
+	uint8_t sign = x->sign;
+
+	reserve_bn(result, n - w);
+	rshift_limbs(result->digits, x->digits + w, n - w, bits % 64);
+
+	result->size = n - w;
+	result->sign = sign;
+	rmzero_bn(result);
+}
+
+/*  Bitwise and of two big numbers, negative numbers behaving as in 
+ *  infinite two's complement. The result may alias the operands.
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void and_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	bitwise_bn(x, y, '&', result);
+}
+
+/*  Bitwise or of two big numbers, negative numbers behaving as in 
+ *  infinite two's complement. The result may alias the operands.
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void or_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	bitwise_bn(x, y, '|', result);
+}
+
+/*  Bitwise exclusive or of two big numbers, negative numbers behaving as 
+ *  in infinite two's complement. The result may alias the operands.
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void xor_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	bitwise_bn(x, y, '^', result);
+}
+
+/*  Bitwise not of a big number in infinite two's complement, -x - 1. The 
+ *  result may alias x.
+ *
+ *  Input: a big number pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void not_bn(BIGNUM *x, BIGNUM *result){
+	if(x->size == 0){
+		set_word_bn(result, 1);
+		result->sign = 0;
+		return;
+	}
+
+	/* ~x = -(x + 1) */
+	copy_bn(result, x);
+	result->sign = !x->sign;
+	sub_ui_bn(result, 1, result);
+}
+
+/*  Tests a bit of the magnitude of a big number
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output: the bit, 0 or 1
+ * 
+ */
+int test_bit_bn(BIGNUM *x, int bit){
+	if(bit / 64 >= x->size){
+		return 0;
+	}
+
+	return (x->digits[bit / 64] >> (bit % 64)) & 1;
+}
+
+/*  Sets a bit of the magnitude of a big number, growing it if needed
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output:
+ * 
+ */
+void set_bit_bn(BIGNUM *x, int bit){
+	int w = bit / 64;
+
+	reserve_bn(x, x->size);
+
+	if(w >= x->size){
+		reserve_bn(x, w + 1);
+		memset(x->digits + x->size, 0, (w + 1 - x->size) * sizeof(uint64_t));
+		x->size = w + 1;
+	}
+
+	x->digits[w] |= (uint64_t)1 << (bit % 64);
+}
+
+/*  Clears a bit of the magnitude of a big number
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output:
+ * 
+ */
+void clear_bit_bn(BIGNUM *x, int bit){
+	if(bit / 64 >= x->size){
+		return;
+	}
+
+	reserve_bn(x, x->size);
+	x->digits[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+	rmzero_bn(x);
+}
+
+/*  Counts the set bits of the magnitude of a big number
+ *
+ *  Input: a big number pointer
+ *  Output: the number of set bits
+ * 
+ */
+int popcount_bn(BIGNUM *x){
+	int count = 0;
+
+	for(int i = 0; i < x->size; i++){
+		count += __builtin_popcountll(x->digits[i]);
+	}
+
+	return count;
+}
+
+/*  Counts the trailing zero bits of a big number
+ *
+ *  Input: a big number pointer
+ *  Output: the index of the lowest set bit, -1 for zero
+ * 
+ */
+int ctz_bn(BIGNUM *x){
+	for(int i = 0; i < x->size; i++){
+		if(x->digits[i] != 0){
+			return i * 64 + __builtin_ctzll(x->digits[i]);
+		}
+	}
+
+	return -1;
+}
+
+/*	Copy a big number to another big number
+ *
+ *  Input: two big numbers pointer
+ *  Output:
+ * 
+ */
+void copy_bn(BIGNUM *a, BIGNUM *b){
+	if(a == b){
+		return;
+	}
+
+	resize_bn(a, b->size);
+	a->sign = b->sign;
+
+	if(b->size > 0){
+		memcpy(a->digits, b->digits, b->size * sizeof(uint64_t));
+	}
+}
+
+/*	Copy a big number to another big number and
+ *	invert the order of the limbs
+ *
+ *  Input: two big numbers pointer
+ *  Output:
+ * 
+ */
+void copy_rev_bn(BIGNUM *a, BIGNUM *b){
+	copy_bn(a, b);
+	rev_bn(a);
+}
+
+/*	Reverse the order of the limbs of the large number
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void rev_bn(BIGNUM *num){
+	reserve_bn(num, num->size);
+
+	for(int i = 0, j = num->size - 1; i < j; i++, j--){
+		uint64_t aux = num->digits[i];
+		num->digits[i] = num->digits[j];
+		num->digits[j] = aux;
+	}
+}
+
+/*	Removes zero limbs to the left of the large number
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void rmzero_bn(BIGNUM *num){
+	while(num->size > 0 && num->digits[num->size - 1] == 0){
+		num->size--;
+	}
+
+	if(num->size == 0){
+		num->sign = 1;
+	}
+}
+
+/*  Compares the magnitude of two large numbers
+ *
+ *  Input: two big numbers pointer
+ *  Output:
+ *			1 - if the first number is greater than the second
+ *    		0 - if the two numbers are equal
+ *   	   -1 - if the first number is less than the second
+ * 
+ */
+int comp_bn(BIGNUM *num1, BIGNUM *num2){
+	return comp_limbs(num1->digits, num1->size, num2->digits, num2->size);
+}
+
+/*	Returns the highest value
+ *
+ *  Input: two integers
+ *  Output: the largest among the integers
+ * 
+ */
+int max(int x, int y){
+	if(x >= y){
+		return x;
+	}
+
+	return y;
+}
+
+/*  Free a big number of memory
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void free_bn(BIGNUM *x){
+	free_digits_bn(x);
+	free(x);
+}
+
+/*  Releases the limbs of a big number that was not created by init_bn, 
+ *  such as one declared with BN_STACK, leaving it empty and reusable
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void clear_bn(BIGNUM *x){
+	free_digits_bn(x);
+
+	x->digits   = x->small;
+	x->size     = 0;
+	x->capacity = BN_INLINE_LIMBS;
+	x->sign     = 1;
+	x->borrowed = 0;
+}
+
+/*  Makes room for at least the specified number of limbs. The buffer 
+ *  grows geometrically so repeated growth costs amortized constant time.
+ *
+ *  Input: a big number pointer, number of limbs
+ *  Output:
+ * 
+ */
+void reserve_bn(BIGNUM *x, int n){
+	if(n <= x->capacity){
+		return;
+	}
+
+	int capacity = max(n, x->capacity * 2);
+
+	if(x->borrowed || x->digits == x->small){
+		/* inline limbs spill to the heap and limbs wrapped by map_bn are 
+		 * never written, both are copied */
+		uint64_t *digits = malloc(capacity * sizeof(uint64_t));
+
+		if(x->size > 0){
+			memcpy(digits, x->digits, x->size * sizeof(uint64_t));
+		}
+
+		x->digits   = digits;
+		x->capacity = capacity;
+		x->borrowed = 0;
+		return;
+	}
+
+	x->digits   = realloc(x->digits, capacity * sizeof(uint64_t));
+	x->capacity = capacity;
+}
+
+/*  Releases the unused limbs of a big number
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void shrink_bn(BIGNUM *x){
+	if(x->size == x->capacity || x->borrowed || x->digits == x->small){
+		return;
+	}
+
+	if(x->size <= BN_INLINE_LIMBS){
+		/* moves back into the inline limbs */
+		if(x->size > 0){
+			memcpy(x->small, x->digits, x->size * sizeof(uint64_t));
+		}
+
+		free(x->digits);
+		x->digits   = x->small;
+		x->capacity = BN_INLINE_LIMBS;
+
+	}else {
+		x->digits   = realloc(x->digits, x->size * sizeof(uint64_t));
+		x->capacity = x->size;
+	}
+}
+
+/*  Initializes an empty scratch context
+ *
+ *  Input:
+ *  Output: a context pointer
+ * 
+ */
+BN_CTX* init_ctx_bn(){
+
+	BN_CTX *ctx = malloc(sizeof(BN_CTX));
+	ctx->pool            = NULL;
+	ctx->used            = 0;
+	ctx->count           = 0;
+	ctx->frames          = NULL;
+	ctx->depth           = 0;
+	ctx->frames_capacity = 0;
+
+	return ctx;
+
+}
+
+/*  Free a context and every scratch number it owns
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void free_ctx_bn(BN_CTX *ctx){
+	for(int i = 0; i < ctx->count; i++){
+		free_bn(ctx->pool[i]);
+	}
+
+	free(ctx->pool);
+	free(ctx->frames);
+	free(ctx);
+}
+
+/*  Binds a context to the calling thread. Every operation run by the 
+ *  thread afterwards takes its temporaries from it. NULL unbinds it, 
+ *  returning the thread to its default context, which is created on 
+ *  first use and freed when the thread exits.
+ *
+ *  Input: a context pointer or NULL
+ *  Output: the context previously bound
+ * 
+ */
+BN_CTX* set_ctx_bn(BN_CTX *ctx){
+	BN_CTX *previous = thread_ctx;
+
+	thread_ctx = ctx;
+
+	return previous;
+}
+
+/*  Opens a frame on the context, numbers obtained afterwards are 
+ *  released together by the matching end_ctx_bn
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void start_ctx_bn(BN_CTX *ctx){
+	if(ctx->depth == ctx->frames_capacity){
+		ctx->frames_capacity = max(8, ctx->frames_capacity * 2);
+		ctx->frames = realloc(ctx->frames, ctx->frames_capacity * sizeof(int));
+	}
+
+	ctx->frames[ctx->depth++] = ctx->used;
+}
+
+/*  Takes a scratch number from the current frame of the context. The 
+ *  number starts as zero and keeps the limbs of its previous uses.
+ *
+ *  Input: a context pointer
+ *  Output: a big number pointer valid until the frame is closed
+ * 
+ */
+BIGNUM* get_ctx_bn(BN_CTX *ctx){
+	if(ctx->used == ctx->count){
+		ctx->pool = realloc(ctx->pool, max(8, ctx->count * 2) * sizeof(BIGNUM*));
+
+		for(int i = ctx->count; i < max(8, ctx->count * 2); i++){
+			ctx->pool[i] = init_bn();
+		}
+
+		ctx->count = max(8, ctx->count * 2);
+	}
+
+	BIGNUM *num = ctx->pool[ctx->used++];
+	num->size = 0;
+	num->sign = 1;
+
+	return num;
+}
+
+/*  Closes the current frame of the context
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void end_ctx_bn(BN_CTX *ctx){
+	ctx->used = ctx->frames[--ctx->depth];
+}
+
+/*  Prints a big number
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void print_bn(BIGNUM *num){
+	if(num->sign){
+		putchar('+');
+	}
+
+	bn_write(num, stdout);
+}
+
+/*  Prints a big number with line break
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void println_bn(BIGNUM *num){
+	print_bn(num);
+	putchar('\n');
+}
+
+/*  Generates a large random number with up to the specified number of
+ *  limbs, [0, 2^(64 * maximum size)[.
+ *
+ *  Input: maximum size in limbs, a big number pointer
+ *  Output:
+ * 
+ */
+void random_bn(uintmax_t max_random_size, BIGNUM *result){
+
+	int size = rand() % max_random_size + 1;
+
+	resize_bn(result, size);
+	result->sign = 1;
+
+	for(int i = 0; i < size; i++){
+		result->digits[i] = ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+	}
+
+	rmzero_bn(result);
+}
+
+/*  Generates a large random number between the first and the second
+ *  large number specified, [lower limit, upper limit[.
+ *
+ *  Input: lower limit, upper limit, a big number pointer
+ *  Output:
+ * 
+ */
+void random_range_bn(BIGNUM *start, BIGNUM *end, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *sub = get_ctx_bn(ctx);
+	sub_bn(end, start, sub);
+
+	BIGNUM *rand = get_ctx_bn(ctx);
+	random_bn(sub->size + 1, rand);
+
+	BIGNUM *mod  = get_ctx_bn(ctx);
+	mod_bn(rand, sub, mod);
+
+	sum_bn(mod, start, result);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Adds two big numbers
+ *
+ *  Input: big number to be added, big number to be added, a big number pointer
+ *  Output:
+ * 
+ */
+void sum_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	add_signed_bn(x, y, y->sign, result);
+}
+
+/*  Subtracts two large numbers
+ *
+ *  Input: minuend in big number format, subtrahend in big number format,
+ *         a big number pointer
+ *  Output:
+ * 
+ */
+void sub_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	add_signed_bn(x, y, y->size == 0 || !y->sign, result);
+}
+
+/*  Add zero limbs to the left to make the large number the specified size
+ *
+ *  Input: a big number pointer, integer number specifying the size that the big number will be
+ *  Output:
+ * 
+ */
+void fill(BIGNUM *x, int n){
+	if (x->size < n){
+		int size = x->size;
+		resize_bn(x, n);
+
+		memset(x->digits + size, 0, (n - size) * sizeof(uint64_t));
+	}
+}
+
+/*  Split a big number between two limb positions, counted from the least
+ *  significant limb
+ *
+ *  Input: a big number pointer, integer containing the starting position value,
+ *	       integer containing the final position value, a big number pointer
+ *  Output:
+ * 
+ */
+void split(BIGNUM *x, int start, int end, BIGNUM *result){
+	if(end > x->size){
+		end = x->size;
+	}
+	if(start > end){
+		start = end;
+	}
+
+	reserve_bn(result, end - start);
+	memmove(result->digits, x->digits + start, (end - start) * sizeof(uint64_t));
+
+	result->size = end - start;
+	result->sign = 1;
+	rmzero_bn(result);
+}
+
+/*  Performs base 10 exponentiation quickly
+ *
+ *  Input: integer containing the exponent value, a big number pointer
+ *  Output:
+ * 
+ */
+void fastpow_base10_bn(BIGNUM *e, BIGNUM *result){
+	pow_bn(&ten_bn, e, result);
+}
+
+/*  Performs a multiplication of big numbers using the karatsuba algorithm,
+ *  mul_bn already switches to it for large operands
+ *
+ *  Input: two big numbers that will be multiplied, a big number pointer
+ *  Output:
+ * 
+ */
+void karatsuba(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	int n = max(x->size, y->size);
+	uint8_t sign = x->sign == y->sign;
+
+	if(x->size == 0 || y->size == 0){
+		resize_bn(result, 0);
+		result->sign = 1;
+		return;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *a = get_ctx_bn(ctx);
+	BIGNUM *b = get_ctx_bn(ctx);
+	BIGNUM *r = get_ctx_bn(ctx);
+	BIGNUM *scratch = get_ctx_bn(ctx);
+
+	copy_bn(a, x);
+	copy_bn(b, y);
+	fill(a, n);
+	fill(b, n);
+
+	resize_bn(r, 2 * n);
+	reserve_bn(scratch, kara_scratch_limbs(n));
+
+	kara_mul_limbs(r->digits, a->digits, b->digits, n, scratch->digits);
+
+	r->sign = sign;
+	rmzero_bn(r);
+	swap_bn(r, result);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Multiplies two big numbers. Scratch space is taken from the context 
+ *  only by the Karatsuba and larger methods or when the result is one of 
+ *  the operands and outgrows the inline limbs, so small products do not 
+ *  allocate.
+ *
+ *  Input: two big numbers that will be multiplied, a big number pointer
+ *  Output:
+ * 
+ */
+void mul_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	if(x == y){
+		sqr_bn(x, result);
+		return;
+	}
+
+	uint8_t sign = x->sign == y->sign;
+
+	if(x->size == 0 || y->size == 0){
+		resize_bn(result, 0);
+		result->sign = 1;
+		return;
+	}
+
+	BN_CTX *ctx = NULL;
+	BN_STACK(tmp);
+
+	BIGNUM *r = result;
+	if(r == x || r == y){
+		if(x->size + y->size <= BN_INLINE_LIMBS){
+			r = &tmp;
+		}else {
+			ctx = enter_ctx_bn();
+			r = get_ctx_bn(ctx);
+		}
+	}
+
+	resize_bn(r, x->size + y->size);
+
+	if(x->size >= y->size){
+		mul_limbs(r->digits, x->digits, x->size, y->digits, y->size);
+	}else {
+		mul_limbs(r->digits, y->digits, y->size, x->digits, x->size);
+	}
+
+	r->sign = sign;
+	rmzero_bn(r);
+
+	if(r != result){
+		swap_bn(r, result);
+	}
+
+	clear_bn(&tmp);
+
+	if(ctx != NULL){
+		leave_ctx_bn(ctx);
+	}
+}
+
+/*  Squares a big number, taking scratch space from the context under 
+ *  the same conditions as mul_bn
+ *
+ *  Input: the big number to be squared, a big number pointer
+ *  Output:
+ * 
+ */
+void sqr_bn(BIGNUM *x, BIGNUM *result){
+	if(x->size == 0){
+		resize_bn(result, 0);
+		result->sign = 1;
+		return;
+	}
+
+	BN_CTX *ctx = NULL;
+	BN_STACK(tmp);
+
+	BIGNUM *r = result;
+	if(r == x){
+		if(2 * x->size <= BN_INLINE_LIMBS){
+			r = &tmp;
+		}else {
+			ctx = enter_ctx_bn();
+			r = get_ctx_bn(ctx);
+		}
+	}
+
+	resize_bn(r, 2 * x->size);
+	sqr_limbs(r->digits, x->digits, x->size);
+
+	r->sign = 1;
+	rmzero_bn(r);
+
+	if(r != result){
+		swap_bn(r, result);
+	}
+
+	clear_bn(&tmp);
+
+	if(ctx != NULL){
+		leave_ctx_bn(ctx);
+	}
+}
+
+/*  Divides two big numbers computing the quotient and the remainder in 
+ *  a single pass. Single limb divisors use divmod_1_limbs and longer ones 
+ *  Algorithm D on the remainder buffer. The quotient is truncated and the 
+ *  remainder has the sign of the dividend.
+ *
+ *  Input: dividend in big number format, divisor in big number format,
+ *         a big number pointer for the quotient or NULL, a big number
+ *         pointer for the remainder or NULL
+ *  Output:
+ * 
+ */
+void divmod_bn(BIGNUM *x, BIGNUM *y, BIGNUM *quotient, BIGNUM *remainder){
+	uint8_t qsign = x->sign == y->sign;
+	uint8_t rsign = x->sign;
+
+	if(comp_limbs(x->digits, x->size, y->digits, y->size) == -1){
+		if(remainder != NULL){
+			copy_bn(remainder, x);
+		}
+		if(quotient != NULL){
+			resize_bn(quotient, 0);
+			quotient->sign = 1;
+		}
+		return;
+	}
+
+	if(y->size == 1){
+		uint64_t d = y->digits[0];
+		uint64_t rem;
+
+		if(quotient != NULL){
+			reserve_bn(quotient, x->size);
+			rem = divmod_1_limbs(quotient->digits, x->digits, x->size, d);
+
+			quotient->size = x->size;
+			quotient->sign = qsign;
+			rmzero_bn(quotient);
+
+		}else {
+			rem = divmod_1_limbs(NULL, x->digits, x->size, d);
+		}
+
+		if(remainder != NULL){
+			resize_bn(remainder, 1);
+			remainder->digits[0] = rem;
+			remainder->sign = rsign;
+			rmzero_bn(remainder);
+		}
+
+		return;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	/* the quotient is built while x and y are still being read, and the
+	   remainder while y is, so they go through scratch numbers only when
+	   they alias those operands. A remainder aliasing x is reduced in 
+	   place. */
+	BIGNUM *q = quotient;
+	BIGNUM *r = remainder;
+
+	if(q == x || q == y){
+		q = get_ctx_bn(ctx);
+	}
+	if(r == NULL || r == y){
+		r = get_ctx_bn(ctx);
+	}
+
+	int xn = x->size;
+	int dn = y->size;
+	int shift = __builtin_clzll(y->digits[dn - 1]);
+
+	/* normalizes the divisor so that its top bit is set and shifts the 
+	   dividend along, which leaves the quotient unchanged */
+	const uint64_t *d = y->digits;
+
+	if(shift){
+		BIGNUM *yn = get_ctx_bn(ctx);
+		reserve_bn(yn, dn);
+		lshift_limbs(yn->digits, y->digits, dn, shift);
+		d = yn->digits;
+	}
+
+	reserve_bn(r, xn + 1);
+	r->digits[xn] = lshift_limbs(r->digits, x->digits, xn, shift);
+
+	if(q != NULL){
+		resize_bn(q, xn - dn + 1);
+	}
+
+	if(dn < DC_DIV_THRESHOLD || xn + 1 - dn < DC_DIV_THRESHOLD){
+		divrem_limbs(q != NULL ? q->digits : NULL, r->digits, xn + 1, d, dn);
+
+	}else {
+		if(q == NULL){
+			q = get_ctx_bn(ctx);
+			resize_bn(q, xn - dn + 1);
+		}
+
+		dc_divrem_limbs(q->digits, r->digits, xn + 1, d, dn);
+	}
+
+	rshift_limbs(r->digits, r->digits, dn, shift);
+
+	r->size = dn;
+	r->sign = rsign;
+	rmzero_bn(r);
+
+	if(q != NULL){
+		q->sign = qsign;
+		rmzero_bn(q);
+	}
+
+	if(q != quotient && quotient != NULL){
+		swap_bn(q, quotient);
+	}
+	if(r != remainder && remainder != NULL){
+		swap_bn(r, remainder);
+	}
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Divides two big numbers
+ *
+ *  Input: dividend in big number format, divisor in big number
+ *         format, a big number pointer
+ *  Output:
+ * 
+ */
+void div_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	divmod_bn(x, y, result, NULL);
+}
+
+/*  Performs the module operation between two large numbers
+ *
+ *  Input: dividend in big number format, divisor in big number
+ *         format, a big number pointer
+ *  Output:
+ * 
+ */
+void mod_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result){
+	divmod_bn(x, y, NULL, result);
+}
+
+/*  Adds a machine word to a big number in a single pass. The result may 
+ *  alias x.
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void add_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result){
+	BIGNUM w = { .digits = &y, .sign = 1, .size = y != 0, .capacity = 0 };
+
+	add_signed_bn(x, &w, 1, result);
+}
+
+/*  Subtracts a machine word from a big number in a single pass. The 
+ *  result may alias x.
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void sub_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result){
+	BIGNUM w = { .digits = &y, .sign = 1, .size = y != 0, .capacity = 0 };
+
+	add_signed_bn(x, &w, 0, result);
+}
+
+/*  Multiplies a big number by a machine word in a single pass. The 
+ *  result may alias x.
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void mul_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result){
+	uint8_t sign = x->sign;
+	int n = x->size;
+
+	reserve_bn(result, n + 1);
+	result->digits[n] = mul_1_limbs(result->digits, x->digits, n, y);
+
+	result->size = n + 1;
+	result->sign = sign;
+	rmzero_bn(result);
+}
+
+/*  Divides a big number by a nonzero machine word in a single pass, with 
+ *  the quotient truncated toward zero like div_bn. The quotient may alias 
+ *  x or be NULL.
+ *
+ *  Input: dividend in big number format, the divisor, a big number 
+ *         pointer or NULL
+ *  Output: the remainder of the magnitude of x
+ * 
+ */
+uint64_t divmod_ui_bn(BIGNUM *x, uint64_t d, BIGNUM *quotient){
+	if(quotient == NULL){
+		return divmod_1_limbs(NULL, x->digits, x->size, d);
+	}
+
+	uint8_t sign = x->sign;
+	int n = x->size;
+
+	reserve_bn(quotient, n);
+	uint64_t r = divmod_1_limbs(quotient->digits, x->digits, n, d);
+
+	quotient->size = n;
+	quotient->sign = sign;
+	rmzero_bn(quotient);
+
+	return r;
+}
+
+/*  Calculates the remainder of the magnitude of a big number by a 
+ *  nonzero machine word
+ *
+ *  Input: dividend in big number format, the divisor
+ *  Output: the remainder
+ * 
+ */
+uint64_t mod_ui_bn(BIGNUM *x, uint64_t d){
+	return divmod_1_limbs(NULL, x->digits, x->size, d);
+}
+
+/*  Raises a big number to a machine word exponent
+ *
+ *  Input: base in big number format, the exponent, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_ui_bn(BIGNUM *x, uint64_t e, BIGNUM *result){
+	BIGNUM w = { .digits = &e, .sign = 1, .size = e != 0, .capacity = 0 };
+
+	pow_bn(x, &w, result);
+}
+
+/*  Calculates the inverse multiplicative module of two big numbers 
+ *  with the extended Lehmer algorithm. Only the cofactor of x is kept: 
+ *  each batch of Euclidean steps simulated on the leading bits by 
+ *  lehmer_word is applied to the remainders and to that cofactor, and a 
+ *  full division step is taken when no quotient is certain.
+ *
+ *  Input: dividend in big number format, divisor in big number
+ *         format, a big number pointer
+ *  Output:
+ *
+ *	Pseudocode:
+ *			a, sa = m, 0
+ *			b, sb = x mod m, 1
+ *
+ *			while b != 0:
+ *				(a, b), (sa, sb) = M (a, b), M (sa, sb)
+ *
+ *			return sa mod m if a = 1, 0 otherwise
+ * 
+ */
+void mod_inverse_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *m  = get_ctx_bn(ctx);
+	BIGNUM *a  = get_ctx_bn(ctx);
+	BIGNUM *b  = get_ctx_bn(ctx);
+	BIGNUM *sa = get_ctx_bn(ctx);
+	BIGNUM *sb = get_ctx_bn(ctx);
+	BIGNUM *t  = get_ctx_bn(ctx);
+	BIGNUM *u  = get_ctx_bn(ctx);
+	BIGNUM *q  = get_ctx_bn(ctx);
+
+	copy_bn(m, yy);
+	m->sign = 1;
+
+	mod_bn(xx, m, b);
+	if(b->sign == 0){
+		sum_bn(b, m, b);
+	}
+
+	copy_bn(a, m);
+	set_word_bn(sb, 1);
+
+	/* invariants: a = sa x mod m, b = sb x mod m and a > b */
+	while(b->size != 0){
+		int n = a->size;
+		int64_t c[4] = {0, 0, 0, 0};
+
+		if(n >= GCD_LEHMER_THRESHOLD){
+			lehmer_word(a->digits, n, b->digits, b->size, c);
+		}
+
+		if(c[1] == 0){
+			/* a - q b is the remainder, reduced in place */
+			divmod_bn(a, b, q, a);
+			swap_bn(a, b);
+
+			mul_bn(q, sb, t);
+			sub_bn(sa, t, sa);
+			swap_bn(sa, sb);
+			continue;
+		}
+
+		reserve_bn(b, n);
+		memset(b->digits + b->size, 0, (n - b->size) * sizeof(uint64_t));
+
+		resize_bn(t, n);
+		resize_bn(u, n);
+		lincomb_limbs(t->digits, a->digits, b->digits, n, c[0], c[1]);
+		lincomb_limbs(u->digits, a->digits, b->digits, n, c[2], c[3]);
+		t->sign = 1;
+		u->sign = 1;
+		rmzero_bn(t);
+		rmzero_bn(u);
+
+		swap_bn(a, t);
+		swap_bn(b, u);
+
+		mul_si_bn(sa, c[0], t);
+		mul_si_bn(sb, c[1], u);
+		sum_bn(t, u, q);
+
+		mul_si_bn(sa, c[2], t);
+		mul_si_bn(sb, c[3], u);
+		sum_bn(t, u, sb);
+
+		swap_bn(sa, q);
+	}
+
+	if(a->size != 1 || a->digits[0] != 1){
+		/* x and m share a factor, there is no inverse */
+		set_word_bn(result, 0);
+
+	}else if(sa->sign == 0){
+		sum_bn(sa, m, result);
+
+	}else {
+		mod_bn(sa, m, result);
+
+	}
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Inverts n big numbers modulo the same m with Montgomery's trick: one 
+ *  inversion of the product of all of them and 3(n - 1) modular 
+ *  multiplications. The results may alias the inputs.
+ *
+ *  Input: array of big numbers to invert, its size, modulus in big 
+ *         number format, array of n big number pointers for the results
+ *  Output:
+ *
+ *	Pseudocode:
+ *			c[i] = x[0] x[1] ... x[i] mod m
+ *			inv = c[n - 1]^-1 mod m
+ *
+ *			for i from n - 1 down to 1:
+ *				result[i] = inv c[i - 1] mod m
+ *				inv = inv x[i] mod m
+ *
+ *			result[0] = inv
+ * 
+ */
+void batch_inverse_bn(BIGNUM **x, int n, BIGNUM *m, BIGNUM **result){
+	if(n <= 0){
+		return;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *inv = get_ctx_bn(ctx);
+	BIGNUM *t   = get_ctx_bn(ctx);
+	BIGNUM *p   = get_ctx_bn(ctx);
+	BIGNUM **c  = (BIGNUM**)malloc(n * sizeof(BIGNUM*));
+
+	c[0] = get_ctx_bn(ctx);
+	copy_bn(c[0], x[0]);
+
+	for(int i = 1; i < n; i++){
+		c[i] = get_ctx_bn(ctx);
+
+		mul_bn(c[i - 1], x[i], p);
+		mod_bn(p, m, c[i]);
+	}
+
+	mod_inverse_bn(c[n - 1], m, inv);
+
+	for(int i = n - 1; i > 0; i--){
+		mul_bn(inv, x[i], p);
+		mod_bn(p, m, t);
+		if(t->sign == 0){
+			sum_bn(t, m, t);
+		}
+
+		mul_bn(inv, c[i - 1], p);
+		mod_bn(p, m, result[i]);
+		if(result[i]->sign == 0){
+			sum_bn(result[i], m, result[i]);
+		}
+
+		swap_bn(inv, t);
+	}
+
+	copy_bn(result[0], inv);
+
+	free(c);
+	leave_ctx_bn(ctx);
+}
+
+/*  Calculates the exponentiation of a big number
+ *
+ *  Input: base in large number format, exponent in
+ *         big number format, a big number pointer
+ *  Output:
+ *
+ *	Pseudocode:
+ *			table = [base, base^3, ..., base^(2^k - 1)]
+ *			result = 1
+ *
+ *			for each window of the expoent, from the most significant bit:
+ *				if window = 0:
+ *					result = result * result
+ *				else (window of l bits starting and ending with one):
+ *					result = result^(2^l) * table[window / 2]
+ *
+ *			return result
+ * 
+ */
+void pow_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *result){
+	BN_REDUCER red = { .mont = NULL, .barrett = NULL };
+
+	pow_window_bn(bb, ee, &red, &one_bn, result);
+}
+
+/*  Calculates the modular exponentiation of a big number, with 
+ *  Montgomery multiplication for odd moduli and Barrett reduction 
+ *  otherwise. The result is in [0, m).
+ *
+ *  Input: base in large number format, exponent in
+ *         big number format, modulus in big number format, a big 
+ *         number pointer
+ *  Output:
+ *
+ *	Pseudocode:
+ *			base %= m
+ *			table = [base, base^3, ..., base^(2^k - 1)] % m
+ *			result = 1
+ *
+ *			for each window of the expoent, from the most significant bit:
+ *				if window = 0:
+ *					result = (result * result) % m
+ *				else (window of l bits starting and ending with one):
+ *					result = (result^(2^l) * table[window / 2]) % m
+ *
+ *			return result
+ * 
+ */
+void pow_mod_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *mm, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	if(mm->size > 0 && (mm->digits[0] & 1)){
+		BN_MONT mont = { .n = get_ctx_bn(ctx), .rr = get_ctx_bn(ctx) };
+
+		set_mont_bn(&mont, mm);
+		pow_mod_mont_bn(bb, ee, &mont, result);
+
+		leave_ctx_bn(ctx);
+		return;
+	}
+
+	BN_BARRETT barrett = { .m = get_ctx_bn(ctx), .mu = get_ctx_bn(ctx) };
+
+	set_barrett_bn(&barrett, mm);
+	pow_mod_barrett_bn(bb, ee, &barrett, result);
+
+	leave_ctx_bn(ctx);
+}
+
+/*  Creates a Montgomery context for an odd modulus, holding the modulus, 
+ *  R^2 mod m and -m^-1 mod 2^64, where R = 2^64 to the number of limbs 
+ *  of m. It can be reused by any number of operations under m.
+ *
+ *  Input: odd modulus in big number format
+ *  Output: pointer to the Montgomery context
+ * 
+ */
+BN_MONT* init_mont_bn(BIGNUM *m){
+	BN_MONT *mont = (BN_MONT*)malloc(sizeof(BN_MONT));
+
+	mont->n  = init_bn();
+	mont->rr = init_bn();
+
+	set_mont_bn(mont, m);
+
+	return mont;
+}
+
+/*  Frees a Montgomery context
+ *
+ *  Input: a Montgomery context pointer
+ *  Output:
+ * 
+ */
+void free_mont_bn(BN_MONT *mont){
+	free_bn(mont->n);
+	free_bn(mont->rr);
+	free(mont);
+}
+
+/*  Converts a big number to Montgomery form, x * R mod m
+ *
+ *  Input: a big number pointer, a Montgomery context, a big number pointer
+ *  Output:
+ * 
+ */
+void to_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *t = get_ctx_bn(ctx);
+	mod_bn(x, mont->n, t);
+
+	if(t->sign == 0){
+		sum_bn(t, mont->n, t);
+	}
+
+	mul_mont_bn(t, mont->rr, mont, result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Prints a big number
+/*  Converts a big number out of Montgomery form, x * R^-1 mod m
  *
- *  Input: a big number pointer
+ *  Input: a big number in Montgomery form, a Montgomery context, a big 
+ *         number pointer
  *  Output:
  * 
  */
-void print_bn(BIGNUM *num){
-	if(num->sign){
-		printf("+");
-	
-	}else {
-		printf("-");
-	
-	}
+void from_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result){
+	int n = mont->n->size;
+
+	BN_CTX *ctx = enter_ctx_bn();
 
-	for(int i = 0; i < num->size; i++){
-		printf("%i", num->digits[i]);
+	BIGNUM *t = get_ctx_bn(ctx);
+	resize_bn(t, 2 * n);
+	memset(t->digits, 0, 2 * n * sizeof(uint64_t));
+
+	if(x->size > 0){
+		memcpy(t->digits, x->digits, x->size * sizeof(uint64_t));
 	}
+
+	resize_bn(result, n);
+	redc_limbs(result->digits, t->digits, mont->n->digits, n, mont->ninv);
+
+	result->sign = 1;
+	rmzero_bn(result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Prints a big number with line break
+/*  Multiplies two big numbers in Montgomery form, x * y * R^-1 mod m
  *
- *  Input: a big number pointer
+ *  Input: two big numbers in Montgomery form below m, a Montgomery 
+ *         context, a big number pointer
  *  Output:
  * 
  */
-void println_bn(BIGNUM *num){
-	if(num->sign){
-		printf("+");
-	
-	}else {
-		printf("-");
-	
+void mul_mont_bn(BIGNUM *x, BIGNUM *y, BN_MONT *mont, BIGNUM *result){
+	if(x == y){
+		sqr_mont_bn(x, mont, result);
+		return;
 	}
 
-	for(int i = 0; i < num->size; i++){
-		printf("%i", num->digits[i]);
+	int n = mont->n->size;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *t = get_ctx_bn(ctx);
+	resize_bn(t, 2 * n);
+	memset(t->digits, 0, 2 * n * sizeof(uint64_t));
+
+	if(x->size > 0 && y->size > 0){
+		if(x->size >= y->size){
+			mul_limbs(t->digits, x->digits, x->size, y->digits, y->size);
+		}else {
+			mul_limbs(t->digits, y->digits, y->size, x->digits, x->size);
+		}
 	}
 
-	printf("\n");
+	resize_bn(result, n);
+	redc_limbs(result->digits, t->digits, mont->n->digits, n, mont->ninv);
+
+	result->sign = 1;
+	rmzero_bn(result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Generates a large random number between 0 and the specified value,
- *	[0, maximum value[.
+/*  Squares a big number in Montgomery form, x * x * R^-1 mod m
  *
- *  Input: maximum value, a big number pointer
+ *  Input: a big number in Montgomery form below m, a Montgomery context, 
+ *         a big number pointer
  *  Output:
  * 
  */
-void random_bn(uintmax_t max_random_size, BIGNUM *result){
-	
-	int size = rand() % max_random_size + 1;
-	
-	BIGNUM *result_temp = malloc(sizeof(BIGNUM));
-	result_temp->digits = malloc(size);
-	result_temp->size = size;
-	result_temp->sign = 1;
+void sqr_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result){
+	int n = mont->n->size;
 
-	for(int i = 0; i < size; i++){
-		result_temp->digits[i] = rand() % 10;
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *t = get_ctx_bn(ctx);
+	resize_bn(t, 2 * n);
+	memset(t->digits, 0, 2 * n * sizeof(uint64_t));
+
+	if(x->size > 0){
+		sqr_limbs(t->digits, x->digits, x->size);
 	}
 
-	copy_bn(result, result_temp);
-	free_bn(result_temp);
+	resize_bn(result, n);
+	redc_limbs(result->digits, t->digits, mont->n->digits, n, mont->ninv);
+
+	result->sign = 1;
+	rmzero_bn(result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Generates a large random number between the first and the second 
- *  large number specified, [lower limit, upper limit[.
+/*  Calculates the modular exponentiation of a big number under the 
+ *  modulus of a Montgomery context with a sliding window over the 
+ *  exponent. The sign of the exponent is ignored and the result is in 
+ *  [0, m).
  *
- *  Input: lower limit, upper limit, a big number pointer
+ *  Input: base in big number format, exponent in big number format, a 
+ *         Montgomery context, a big number pointer
  *  Output:
  * 
  */
-void random_range_bn(BIGNUM *start, BIGNUM *end, BIGNUM *result){
-	BIGNUM *sub = init_bn();
-	sub_bn(end, start, sub);
-	
-	BIGNUM *rand = init_bn();
-	random_bn(sub->size + 1, rand);
+void pow_mod_mont_bn(BIGNUM *bb, BIGNUM *ee, BN_MONT *mont, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
 
-	BIGNUM *mod  = init_bn();
-	mod_bn(rand, sub, mod);
-	
-	BIGNUM *result_temp = init_bn();
-	sum_bn(mod, start, result_temp);
+	BIGNUM *b   = get_ctx_bn(ctx);
+	BIGNUM *one = get_ctx_bn(ctx);
+
+	to_mont_bn(bb, mont, b);
+	to_mont_bn(&one_bn, mont, one);
 
-	copy_bn(result, result_temp);
+	BN_REDUCER red = { .mont = mont, .barrett = NULL };
 
-	free_bn(sub);
-	free_bn(rand);
-	free_bn(mod);
-	free_bn(result_temp);
+	pow_window_bn(b, ee, &red, one, result);
+	from_mont_bn(result, mont, result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Adds two big numbers
+/*  Creates a Barrett context for any modulus, holding the modulus and 
+ *  mu = floor(2^(128k) / m), where k is the number of limbs of m. It can 
+ *  be reused by any number of reductions modulo m.
  *
- *  Input: big number to be added, big number to be added, a big number pointer
- *  Output:
+ *  Input: modulus in big number format
+ *  Output: pointer to the Barrett context
  * 
  */
-void sum_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+BN_BARRETT* init_barrett_bn(BIGNUM *m){
+	BN_BARRETT *barrett = (BN_BARRETT*)malloc(sizeof(BN_BARRETT));
 
-	copy_rev_bn(x, xx);
-	copy_rev_bn(y, yy);
+	barrett->m  = init_bn();
+	barrett->mu = init_bn();
 
-	if(x->sign != y->sign){
-		if(x->sign == 1){
-			y->sign = 1;
-			sub_bn(x, y, result);
-		
-		}else {
-			x->sign = 1;
-			sub_bn(y, x, result);
-		}
-	
+	set_barrett_bn(barrett, m);
 
-	}else if(comp_bn(y, x) == 1){
-		
-		sum_bn(y, x, result);
-
-	}else{
+	return barrett;
+}
 
-		if(x->size >= y->size){
-			copy_bn(result, x);
+/*  Frees a Barrett context
+ *
+ *  Input: a Barrett context pointer
+ *  Output:
+ * 
+ */
+void free_barrett_bn(BN_BARRETT *barrett){
+	free_bn(barrett->m);
+	free_bn(barrett->mu);
+	free(barrett);
+}
 
+/*  Reduces a big number modulo the modulus of a Barrett context with the 
+ *  same result as mod_bn. Numbers below 2^(128k), which includes any 
+ *  product of two reduced numbers, cost two multiplications and a 
+ *  subtraction (Handbook of Applied Cryptography, 14.42), larger ones 
+ *  fall back to mod_bn. Unless quotient is NULL it receives the quotient 
+ *  of a nonnegative x, which may alias x but not the remainder.
+ *
+ *  Input: a big number pointer, a Barrett context, a big number pointer 
+ *         or NULL, a big number pointer
+ *  Output:
+ * 
+ */
+static void divmod_barrett_bn(BIGNUM *x, BN_BARRETT *barrett, BIGNUM *quotient, BIGNUM *remainder){
+	BIGNUM *m  = barrett->m;
+	BIGNUM *mu = barrett->mu;
+	int k  = m->size;
+	int xn = x->size;
+
+	if(xn > 2 * k){
+		if(quotient != NULL){
+			divmod_bn(x, m, quotient, remainder);
 		}else {
-			copy_bn(result, y);
+			mod_bn(x, m, remainder);
 		}
+		return;
+	}
 
-		result->digits = realloc(result->digits, ++result->size);
-		
-		int carry = 0, i;
-		for (i = 0; i <= x->size && i <= y->size; ++i){
-			result->digits[i] = carry + x->digits[i] + y->digits[i];
-			carry = result->digits[i] / 10;
-			result->digits[i] %= 10;
-		
+	if(comp_limbs(x->digits, xn, m->digits, k) == -1){
+		copy_bn(remainder, x);
+		if(quotient != NULL){
+			set_word_bn(quotient, 0);
 		}
+		return;
+	}
 
-		result->digits[i] = carry;
+	BN_CTX *ctx = enter_ctx_bn();
 
-		rev_bn(result);
+	BIGNUM *q = get_ctx_bn(ctx);
+	BIGNUM *t = get_ctx_bn(ctx);
+	BIGNUM *r = remainder;
 
-		free_bn(x);
-		free_bn(y);
+	uint8_t sign = x->sign;
+
+	/* q3 = floor(floor(x / b^(k-1)) * mu / b^(k+1)) */
+	const uint64_t *q1 = x->digits + k - 1;
+	int q1n = xn - k + 1;
+
+	/* for small moduli only the needed halves of the two products are 
+	   computed, the skipped low partial products of the first one make 
+	   q3 at most one smaller */
+	int schoolbook = k < BARRETT_THRESHOLD;
+
+	resize_bn(q, q1n + mu->size);
+	if(schoolbook){
+		mulhi_basecase_limbs(q->digits, mu->digits, mu->size, q1, q1n, k - 1);
+	}else if(q1n >= mu->size){
+		mul_limbs(q->digits, q1, q1n, mu->digits, mu->size);
+	}else {
+		mul_limbs(q->digits, mu->digits, mu->size, q1, q1n);
 	}
-}
+	rmzero_bn(q);
 
-/*  Subtracts two large numbers
- *
- *  Input: minuend in big number format, subtrahend in big number format, 
- *         a big number pointer
- *  Output:
- * 
- */
-void sub_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+	const uint64_t *q3 = q->digits + k + 1;
+	int q3n = q->size - k - 1;
 
-	copy_bn(x, xx);
-	copy_bn(y, yy);
+	/* r = (x - q3 * m) mod b^(k+1), then a few subtractions of m. x is 
+	   no longer needed, so the result may alias it. */
+	int low = xn < k + 1 ? xn : k + 1;
 
-	if(x->sign != y->sign){
-		if(x->sign == 1){
-			y->sign = 1;
-			sum_bn(x, y, result);
-		
-		}else {
-			y->sign = 0;
-			sum_bn(x, y, result);
-		
-		}
-
-	}else if(comp_bn(y, x) == 1){
-	
-		sub_bn(y, x, result);
-		
-		if(result->sign == 1){
-			result->sign = 0;
-		
+	resize_bn(r, k + 1);
+	if(r != x){
+		memcpy(r->digits, x->digits, low * sizeof(uint64_t));
+	}
+	memset(r->digits + low, 0, (k + 1 - low) * sizeof(uint64_t));
+
+	if(q3n > 0){
+		resize_bn(t, q3n + k);
+		if(schoolbook){
+			mullo_basecase_limbs(t->digits, m->digits, k, q3, q3n, k + 1);
+		}else if(q3n >= k){
+			mul_limbs(t->digits, q3, q3n, m->digits, k);
 		}else {
-			result->sign = 1;
-		
+			mul_limbs(t->digits, m->digits, k, q3, q3n);
 		}
 
-	}else {
+		sub_limbs(r->digits, r->digits, k + 1, t->digits, (q3n + k < k + 1 ? q3n + k : k + 1));
+	}
 
-		BIGNUM *aux = init_bn();
-		aux->sign   = x->sign;
-
-		for(int i = x->size - 1, j = y->size - 1; i >= 0; i--, j--){
-			aux->digits = realloc(aux->digits, ++aux->size);	
-			
-			if(j < 0){
-			
-				aux->digits[aux->size - 1] = x->digits[i];
-
-			}else {
-			
-				if(x->digits[i] - y->digits[j] < 0){
-					aux->digits[aux->size - 1] = (x->digits[i]+10) - y->digits[j];
-
-					for(int k = i - 1; k >= 0; k--){
-						if(x->digits[k] == 0){
-							x->digits[k] = 9;
-						}else {
-							x->digits[k]--;
-							break;
-						}
-					}		
-				}else {
-					aux->digits[aux->size - 1] = x->digits[i] - y->digits[j];
-				}
-			}
-		}
-	
+	rmzero_bn(r);
 
-		rev_bn(aux);
-		rmzero_bn(aux);
+	uint64_t extra = 0;
 
-		copy_bn(result, aux);
-		
-		free_bn(aux);
+	while(comp_limbs(r->digits, r->size, m->digits, k) != -1){
+		sub_limbs(r->digits, r->digits, r->size, m->digits, k);
+		rmzero_bn(r);
+		extra++;
 	}
 
-	free_bn(x);
-	free_bn(y);
-}
-
-/*  Add zeros to the left to make the large number the specified size
- *
- *  Input: a big number pointer, integer number specifying the size that the big number will be
- *  Output:
- * 
- */
-void fill(BIGNUM *x, int n){
-	if (x->size < n){
-		BIGNUM *result = init_bn();
-
-		for (int i = 0; i < (n - x->size); i++){
-			result->digits = realloc(result->digits, ++result->size);
-			result->digits[result->size - 1] = 0;
-		}
+	r->sign = r->size == 0 ? 1 : sign;
 
-		for (int i = 0; i < x->size; i++){
-			result->digits = realloc(result->digits, ++result->size);
-			result->digits[result->size - 1] = x->digits[i];
-		}
+	/* the quotient is q3 plus the subtractions of m */
+	if(quotient != NULL){
+		int qn = q3n > 0 ? q3n : 0;
 
-		copy_bn(x, result);
-		free_bn(result);
+		resize_bn(quotient, qn + 1);
+		memcpy(quotient->digits, q3, qn * sizeof(uint64_t));
+		quotient->digits[qn] = 0;
 
+		add_limbs(quotient->digits, quotient->digits, qn + 1, &extra, 1);
+		quotient->sign = 1;
+		rmzero_bn(quotient);
 	}
 
+	leave_ctx_bn(ctx);
 }
 
-/*  Split a big number between two positions
+/*  Reduces a big number modulo the modulus of a Barrett context with the 
+ *  same result as mod_bn, see divmod_barrett_bn
  *
- *  Input: a big number pointer, integer containing the starting position value, 
- *	       integer containing the final position value, a big number pointer
+ *  Input: a big number pointer, a Barrett context, a big number pointer
  *  Output:
  * 
  */
-void split(BIGNUM *x, int start, int end, BIGNUM *result){
-
-	BIGNUM *result_temp = init_bn();
-
-	for (int i = start; i < end; i++){
-		result_temp->digits = realloc(result_temp->digits, ++result_temp->size);
-		result_temp->digits[result_temp->size - 1] = x->digits[i];
-	}
-
-	copy_bn(result, result_temp);
-	free_bn(result_temp);
+void mod_barrett_bn(BIGNUM *x, BN_BARRETT *barrett, BIGNUM *result){
+	divmod_barrett_bn(x, barrett, NULL, result);
 }
 
-/*  Performs base 10 exponentiation quickly
+/*  Calculates the modular exponentiation of a big number under the 
+ *  modulus of a Barrett context with a sliding window over the exponent. 
+ *  The sign of the exponent is ignored and the result is in [0, m).
  *
- *  Input: integer containing the exponent value, a big number pointer
+ *  Input: base in big number format, exponent in big number format, a 
+ *         Barrett context, a big number pointer
  *  Output:
  * 
  */
-void fastpow_base10_bn(BIGNUM *e, BIGNUM *result){
+void pow_mod_barrett_bn(BIGNUM *bb, BIGNUM *ee, BN_BARRETT *barrett, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
 
-	BIGNUM *one  = int_to_bn(1);
-	BIGNUM *result_temp = int_to_bn(1);
+	BIGNUM *b   = get_ctx_bn(ctx);
+	BIGNUM *one = get_ctx_bn(ctx);
 
-	BIGNUM *i = int_to_bn(0);
-	for (; comp_bn(i, e) == -1;){
-		result_temp->digits = realloc(result_temp->digits, ++result_temp->size);
-		result_temp->digits[result_temp->size - 1] = 0;
-
-		sum_bn(i, one, i);
+	mod_bn(bb, barrett->m, b);
+	if(b->sign == 0){
+		sum_bn(b, barrett->m, b);
 	}
 
-	copy_bn(result, result_temp);
+	mod_bn(&one_bn, barrett->m, one);
+
+	BN_REDUCER red = { .mont = NULL, .barrett = barrett };
 
-	free_bn(one);
-	free_bn(result_temp);
+	pow_window_bn(b, ee, &red, one, result);
+
+	leave_ctx_bn(ctx);
 }
 
-/*  Performs a multiplication of big numbers using the karatsuba algorithm
+/*  Calculates the product of bases[i]^exps[i] mod m over k bases with 
+ *  Straus' interleaved sliding windows: each base has its own table of 
+ *  odd powers and windows, and a single chain of squarings is shared by 
+ *  all of them, so two exponentiations cost little more than one. The 
+ *  reducer is the one of pow_mod_bn. The signs of the exponents are 
+ *  ignored and the result is in [0, m).
  *
- *  Input: two big numbers that will be multiplied, a big number pointer
+ *  Input: array of bases, array of exponents, number of bases, modulus 
+ *         in big number format, a big number pointer
  *  Output:
  * 
  */
-void karatsuba(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
-
-	copy_bn(x, xx);
-	copy_bn(y, yy);
+void multi_pow_mod_bn(BIGNUM **bases, BIGNUM **exps, int k, BIGNUM *m, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
 
-	int n = max(x->size, y->size);
+	BN_MONT mont = { .n = get_ctx_bn(ctx), .rr = get_ctx_bn(ctx) };
+	BN_BARRETT barrett = { .m = get_ctx_bn(ctx), .mu = get_ctx_bn(ctx) };
+	BN_REDUCER red = { .mont = NULL, .barrett = NULL };
 
-	BIGNUM *a = init_bn();
-	BIGNUM *b = init_bn();
-	BIGNUM *c = init_bn();
-	BIGNUM *d = init_bn();
-
-	if(n < 100){
-		BIGNUM *mul = init_bn();
-		mul_bn(x, y, mul);
-		copy_bn(result, mul);
-		free_bn(mul);
-	
+	if(m->digits[0] & 1){
+		set_mont_bn(&mont, m);
+		red.mont = &mont;
 	}else {
+		set_barrett_bn(&barrett, m);
+		red.barrett = &barrett;
+	}
 
-		n = (n / 2) + (n % 2);
-		BIGNUM *N = int_to_bn(n);
-
-		BIGNUM *multiplier = init_bn();
-		fastpow_base10_bn(N, multiplier);
+	/* per base: table, window size, bit length, next bit that may start 
+	   a window, bit and value of the window waiting to be multiplied */
+	BIGNUM **table = (BIGNUM**)malloc((size_t)k * 32 * sizeof(BIGNUM*));
+	int *state = (int*)malloc((size_t)k * 5 * sizeof(int));
 
-		BIGNUM *z0 = init_bn();
-		BIGNUM *z1 = init_bn();
-		BIGNUM *z2 = init_bn();
+	int *window = state;
+	int *bits   = state + k;
+	int *next   = state + 2 * k;
+	int *pend   = state + 3 * k;
+	int *value  = state + 4 * k;
 
-		div_bn(x, multiplier, b);
+	int top = 0;
+	BIGNUM *b2 = get_ctx_bn(ctx);
 
-		BIGNUM *mul1 = init_bn();
-		mul_bn(b, multiplier, mul1);
-		sub_bn(x, mul1, a);
+	for(int i = 0; i < k; i++){
+		BIGNUM *e = exps[i];
+		BIGNUM **t = table + 32 * i;
 
-		div_bn(y, multiplier, d);
+		bits[i]   = bit_length_bn(e);
+		window[i] = window_bits(bits[i]);
+		next[i]   = bits[i] - 1;
+		pend[i]   = -1;
+		top = bits[i] > top ? bits[i] : top;
 
-		BIGNUM *mul2 = init_bn();
-		mul_bn(d, multiplier, mul2);
-		sub_bn(y, mul2, c);
+		t[0] = get_ctx_bn(ctx);
 
+		if(red.mont != NULL){
+			to_mont_bn(bases[i], red.mont, t[0]);
+		}else {
+			mod_bn(bases[i], barrett.m, t[0]);
+			if(t[0]->sign == 0){
+				sum_bn(t[0], barrett.m, t[0]);
+			}
+		}
 
-		BIGNUM *sum1 = init_bn();
-		BIGNUM *sum2 = init_bn();
+		if(window[i] > 1){
+			exp_mul_bn(t[0], t[0], &red, b2);
 
-		sum_bn(a, b, sum1);
-		sum_bn(c, d, sum2);
+			for(int j = 1; j < 1 << (window[i] - 1); j++){
+				t[j] = get_ctx_bn(ctx);
+				exp_mul_bn(t[j - 1], b2, &red, t[j]);
+			}
+		}
+	}
 
-		karatsuba(a, c, z0);
-		karatsuba(sum1, sum2, z1);
-		karatsuba(b, d, z2);
+	BIGNUM *r = get_ctx_bn(ctx);
+	int started = 0;
 
-		/*return*/
-			BIGNUM *pow1 = init_bn();
-			BIGNUM *two  = int_to_bn(2);
-			BIGNUM *mul3  = init_bn();
-			mul_bn(two, N, mul3);
-			fastpow_base10_bn(mul3, pow1);
+	for(int bit = top - 1; bit >= 0; bit--){
+		if(started){
+			exp_mul_bn(r, r, &red, r);
+		}
 
-			BIGNUM *mul4  = init_bn();
-			mul_bn(z2, pow1, mul4);
+		for(int i = 0; i < k; i++){
+			BIGNUM *e = exps[i];
 
-			BIGNUM *sub  = init_bn();
-			BIGNUM *sub1 = init_bn();
-			BIGNUM *mul5  = init_bn();
-			sub_bn(z1, z0, sub);
-			sub_bn(sub, z2, sub1);
-			mul_bn(sub1, multiplier, mul5);
+			if(pend[i] < 0 && next[i] == bit){
+				if(test_bit_bn(e, bit) == 0){
+					next[i]--;
+				}else {
+					int j = bit - window[i] + 1 < 0 ? 0 : bit - window[i] + 1;
+					while(test_bit_bn(e, j) == 0){
+						j++;
+					}
+
+					int w = 0;
+					for(int l = bit; l >= j; l--){
+						w = (w << 1) | test_bit_bn(e, l);
+					}
+
+					pend[i]  = j;
+					value[i] = w;
+					next[i]  = j - 1;
+				}
+			}
 
-			BIGNUM *sum3 = init_bn();
-			BIGNUM *sum4 = init_bn();
-			sum_bn(mul4, mul5, sum3);
-			sum_bn(sum3, z0, sum4);
+			if(pend[i] == bit){
+				if(started){
+					exp_mul_bn(r, table[32 * i + (value[i] >> 1)], &red, r);
+				}else {
+					copy_bn(r, table[32 * i + (value[i] >> 1)]);
+					started = 1;
+				}
+				pend[i] = -1;
+			}
+		}
+	}
 
-			copy_bn(result, sum4);
+	if(!started){
+		mod_bn(&one_bn, red.mont != NULL ? mont.n : barrett.m, result);
+	}else if(red.mont != NULL){
+		from_mont_bn(r, red.mont, result);
+	}else {
+		copy_bn(result, r);
+	}
 
-		/*return*/
+	free(table);
+	free(state);
 
-	}
+	leave_ctx_bn(ctx);
 }
 
-/*  Multiplies two big numbers
+/*  Creates a CRT context for a modulus n = p q with known odd prime 
+ *  factors and CRT exponents dp = d mod (p - 1) and dq = d mod (q - 1). 
+ *  q^-1 mod p is computed once with mod_inverse_bn and each prime gets a 
+ *  Montgomery context. The two halves run in parallel when the library 
+ *  is built with BN_THREADS, which can be turned off by clearing 
+ *  parallel.
  *
- *  Input: two big numbers that will be multiplied, a big number pointer
- *  Output:
+ *  Input: the prime factors p and q, the CRT exponents dp and dq
+ *  Output: pointer to the CRT context
  * 
  */
-void mul_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+BN_CRT* init_crt_bn(BIGNUM *p, BIGNUM *q, BIGNUM *dp, BIGNUM *dq){
+	BN_CRT *crt = (BN_CRT*)malloc(sizeof(BN_CRT));
 
-	copy_bn(x, xx);
-	copy_bn(y, yy);
+	crt->p    = init_bn();
+	crt->q    = init_bn();
+	crt->dp   = init_bn();
+	crt->dq   = init_bn();
+	crt->qinv = init_bn();
 
-	result->digits = calloc(x->size + y->size - 1, 1);
-	result->size   = x->size + y->size - 1;
+	copy_bn(crt->p, p);
+	copy_bn(crt->q, q);
+	copy_bn(crt->dp, dp);
+	copy_bn(crt->dq, dq);
 
-	if(x->sign == y->sign){
-		result->sign = 1;
-	}else {
-		result->sign = 0;
-	
-	}
+	mod_inverse_bn(crt->q, crt->p, crt->qinv);
 
-	for (int yi = y->size - 1; yi >= 0; yi--){
-		uint8_t carry = 0;
-		
-		for (int xi = x->size - 1; xi >= 0; xi--){
-			
-			result->digits[xi + yi] += carry + x->digits[xi] * y->digits[yi];
-			carry = result->digits[xi + yi] / 10;
-			result->digits[yi + xi] %= 10;
-		}
-	}
+	crt->mont_p = init_mont_bn(crt->p);
+	crt->mont_q = init_mont_bn(crt->q);
 
-	free_bn(x);
-	free_bn(y);
+#ifdef BN_THREADS
+	crt->parallel = 1;
+#else
+	crt->parallel = 0;
+#endif
+
+	return crt;
 }
 
-/*  Divides two big numbers
+/*  Frees a CRT context
  *
- *  Input: dividend in big number format, divisor in big number 
- *         format, a big number pointer
+ *  Input: a CRT context pointer
+ *  Output:
+ * 
+ */
+void free_crt_bn(BN_CRT *crt){
+	free_mont_bn(crt->mont_p);
+	free_mont_bn(crt->mont_q);
+
+	free_bn(crt->p);
+	free_bn(crt->q);
+	free_bn(crt->dp);
+	free_bn(crt->dq);
+	free_bn(crt->qinv);
+	free(crt);
+}
+
+/*  Calculates x^d mod p q from the two half size exponentiations 
+ *  m1 = x^dp mod p and m2 = x^dq mod q, recombined with Garner's formula 
+ *  m2 + q ((m1 - m2) q^-1 mod p). The result is in [0, p q).
+ *
+ *  Input: base in big number format, a CRT context, a big number pointer
  *  Output:
  * 
  */
-void div_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+void pow_crt_bn(BIGNUM *x, BN_CRT *crt, BIGNUM *result){
+	BN_CTX *ctx = enter_ctx_bn();
 
-	copy_bn(x, xx);
-	copy_bn(y, yy);
+	BIGNUM *m1 = get_ctx_bn(ctx);
+	BIGNUM *m2 = get_ctx_bn(ctx);
+	BIGNUM *h  = get_ctx_bn(ctx);
 
-	BIGNUM *result_temp = init_bn();
+	BN_CRT_HALF hp = { .x = x, .e = crt->dp, .mont = crt->mont_p, .result = m1 };
+	BN_CRT_HALF hq = { .x = x, .e = crt->dq, .mont = crt->mont_q, .result = m2 };
 
-	if(comp_bn(y, x) == 1){
-		BIGNUM *zero = int_to_bn(0);
-		copy_bn(result, zero);
-		
-		free_bn(zero);
-	
-	}else {
-		
-		if(x->sign == y->sign){
-	
-			result_temp->sign = 1;
-		}else {
-	
-			result_temp->sign = 0;
-	
-		}
-
-		BIGNUM *aux = int_to_bn(0);
-
-		for(int i = 0; i < x->size; i++){
-		
-			aux->digits = realloc(aux->digits, ++aux->size);
-			aux->digits[aux->size - 1] = x->digits[i];
-			rmzero_bn(aux);
-
-			if(comp_bn(aux, y) != -1){		
-				int qaux = 0;
-				while(comp_bn(aux, y) != -1){
-					qaux++;
-				
-					BIGNUM *sub = init_bn();
-					sub_bn(aux, y, sub);
-					copy_bn(aux, sub);
-					
-					free_bn(sub);
-				}	
-		
-				result_temp->digits = realloc(result_temp->digits, ++result_temp->size);
-				result_temp->digits[result_temp->size - 1] = qaux;
-                             
-			}else {
-				
-				result_temp->digits = realloc(result_temp->digits, ++result_temp->size);
-				result_temp->digits[result_temp->size - 1] = 0;
+#ifdef BN_THREADS
+	pthread_t thread;
 
-			}
-		}	
-	
-		rmzero_bn(result_temp);
-		copy_bn(result, result_temp);
-		
-		free_bn(aux);
+	if(crt->parallel && pthread_create(&thread, NULL, crt_half_bn, &hp) == 0){
+		crt_half_bn(&hq);
+		pthread_join(thread, NULL);
+
+	}else {
+		crt_half_bn(&hp);
+		crt_half_bn(&hq);
 	}
+#else
+	crt_half_bn(&hp);
+	crt_half_bn(&hq);
+#endif
+
+	/* h = (m1 - m2) q^-1 mod p, in [0, p) */
+	sub_bn(m1, m2, h);
+	mul_bn(h, crt->qinv, m1);
+	mod_bn(m1, crt->p, h);
+
+	if(h->sign == 0){
+		sum_bn(h, crt->p, h);
+	}
+
+	mul_bn(h, crt->q, m1);
+	sum_bn(m1, m2, result);
 
-	free_bn(x);
-	free_bn(y);
-	free_bn(result_temp);
+	leave_ctx_bn(ctx);
 }
 
-/*  Performs the module operation between two large numbers
+/*  Precomputes a Lim-Lee comb for a fixed base and modulus. With t teeth 
+ *  spaced d = ceil(bits / t) bits apart, entry v of the table is the 
+ *  product of g^(2^(i d)) over the bits i set in v, kept in the form of 
+ *  the reducer of the modulus (Montgomery when odd, Barrett otherwise), 
+ *  so that g^e needs only d squarings and d multiplications.
  *
- *  Input: dividend in big number format, divisor in big number 
- *         format, a big number pointer
- *  Output:
+ *  Input: base in big number format, modulus in big number format, 
+ *         largest exponent length in bits
+ *  Output: pointer to the comb
  * 
  */
-void mod_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+BN_COMB* init_comb_bn(BIGNUM *g, BIGNUM *m, int bits){
+	if(bits < 1){
+		bits = 1;
+	}
 
-	copy_bn(x, xx);
-	copy_bn(y, yy);
+	int teeth   = comb_teeth(bits);
+	int spacing = (bits + teeth - 1) / teeth;
+
+	BN_COMB *comb = alloc_comb_bn(m, teeth, spacing);
+	BN_REDUCER red = { .mont = comb->mont, .barrett = comb->barrett };
+
+	mod_bn(g, comb->m, comb->g);
+	if(comb->g->sign == 0){
+		sum_bn(comb->g, comb->m, comb->g);
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
 
-	if(comp_bn(y, x) == 1){
-		copy_bn(result, x);
+	BIGNUM *p = get_ctx_bn(ctx);
 
+	if(comb->mont != NULL){
+		to_mont_bn(comb->g, comb->mont, p);
+		to_mont_bn(&one_bn, comb->mont, comb->table[0]);
 	}else {
-		BIGNUM *aux = init_bn();
-
-		for(int i = 0; i < x->size; i++){
-			aux->digits = realloc(aux->digits, ++aux->size);
-			aux->digits[aux->size - 1] = x->digits[i];
-			
-			rmzero_bn(aux);
-	
-			if(comp_bn(aux, y) != -1){
-			
-				int qaux = 0;
-				while(comp_bn(aux, y) != -1){
-					qaux++;
-	
-					BIGNUM *sub = init_bn();
-					sub_bn(aux, y, sub);
-
-					copy_bn(aux, sub);
-					free_bn(sub);	
-				}
+		copy_bn(p, comb->g);
+		mod_bn(&one_bn, comb->m, comb->table[0]);
+	}
+
+	/* p runs through g^(2^(i d)), entries with highest tooth i are the 
+	   entries below 2^i times p */
+	for(int i = 0; i < teeth; i++){
+		if(i > 0){
+			for(int j = 0; j < spacing; j++){
+				exp_mul_bn(p, p, &red, p);
 			}
 		}
 
-		copy_bn(result, aux);
-		
-		free_bn(aux);
+		for(int v = 0; v < 1 << i; v++){
+			exp_mul_bn(comb->table[v], p, &red, comb->table[v | 1 << i]);
+		}
 	}
 
-	free_bn(x);
-	free_bn(y);
+	leave_ctx_bn(ctx);
+
+	return comb;
 }
 
-/*  Calculates the inverse multiplicative module of two big numbers 
- *	with the extended euclidean algorithm
+/*  Frees a comb
  *
- *  Input: dividend in big number format, divisor in big number 
- *         format, a big number pointer
+ *  Input: a comb pointer
  *  Output:
  * 
- *	Pseudocode:
- *
  */
-void mod_inverse_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	
-	BIGNUM *s     = int_to_bn(0);
-	BIGNUM *old_s = int_to_bn(1);
+void free_comb_bn(BN_COMB *comb){
+	for(int i = 0; i < 1 << comb->teeth; i++){
+		free_bn(comb->table[i]);
+	}
+	free(comb->table);
 
-	BIGNUM *t     = int_to_bn(1);
-	BIGNUM *old_t = int_to_bn(0);
+	if(comb->mont != NULL){
+		free_mont_bn(comb->mont);
+	}
+	if(comb->barrett != NULL){
+		free_barrett_bn(comb->barrett);
+	}
 
-	BIGNUM *r     = init_bn();
-	BIGNUM *old_r = init_bn();
+	free_bn(comb->g);
+	free_bn(comb->m);
+	free(comb);
+}
 
-	copy_bn(r, yy);
-	copy_bn(old_r, xx);
-	
-	BIGNUM *zero = int_to_bn(0);
+/*  Calculates g^e mod m with the comb of g and m, reading one bit of each 
+ *  tooth per column from the highest column the exponent reaches. 
+ *  Exponents longer than the comb go through pow_mod_bn. The sign of the 
+ *  exponent is ignored and the result is in [0, m).
+ *
+ *  Input: exponent in big number format, a comb, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_comb_bn(BIGNUM *e, BN_COMB *comb, BIGNUM *result){
+	int bits = bit_length_bn(e);
 
-	while(comp_bn(r, zero) != 0){
-	
-		BIGNUM *quotient = init_bn();
-		div_bn(old_r, r, quotient);
+	if(bits > (int64_t)comb->teeth * comb->spacing){
+		pow_mod_bn(comb->g, e, comb->m, result);
+		return;
+	}
 
-		BIGNUM *temp = init_bn();
-		copy_bn(temp, r);
-		
-		BIGNUM *m1 = init_bn();
-		mul_bn(quotient, r, m1);
+	/* columns at or above bits hold no set bit of any tooth */
+	int columns = bits < comb->spacing ? bits : comb->spacing;
 
-		sub_bn(old_r, m1, r);
-		copy_bn(old_r, temp);
+	BN_REDUCER red = { .mont = comb->mont, .barrett = comb->barrett };
 
-		copy_bn(temp, s);
-	
-		mul_bn(quotient, s, m1);
-		sub_bn(old_s, m1, s);
-		copy_bn(old_s, temp);
+	BN_CTX *ctx = enter_ctx_bn();
 
-		copy_bn(temp, t);
-		mul_bn(quotient, t, m1);
-		sub_bn(old_t, m1, t);
-		copy_bn(t, temp);
+	BIGNUM *r = get_ctx_bn(ctx);
+	copy_bn(r, comb->table[0]);
 
-		free_bn(quotient);
-		free_bn(temp);
-		free_bn(m1);
-	}
+	for(int j = columns - 1; j >= 0; j--){
+		exp_mul_bn(r, r, &red, r);
 
-	if(old_s->sign == 0){
-		BIGNUM *s1 = init_bn(); 
-		sum_bn(old_s, yy, s1);
+		int v = 0;
+		for(int i = comb->teeth - 1; i >= 0; i--){
+			int64_t bit = (int64_t)i * comb->spacing + j;
 
-		copy_bn(result, s1);
-		free_bn(s1);
+			v <<= 1;
+			if(bit < bits){
+				v |= test_bit_bn(e, bit);
+			}
+		}
 
-	}else {
-		copy_bn(result, old_s);
+		if(v){
+			exp_mul_bn(r, comb->table[v], &red, r);
+		}
+	}
 
+	if(comb->mont != NULL){
+		from_mont_bn(r, comb->mont, result);
+	}else {
+		copy_bn(result, r);
 	}
 
-	free_bn(s);
-	free_bn(old_s);
-	free_bn(t);
-	free_bn(old_t);
-	free_bn(r);
-	free_bn(old_r);
-	free_bn(zero);
+	leave_ctx_bn(ctx);
 }
 
-/*  Calculates the exponentiation of a big number
+/*  Serializes a comb so that it can be loaded with deserialize_comb_bn 
+ *  instead of being rebuilt. The layout is the magic "BNCB", the number 
+ *  of teeth, the spacing and the modulus size k as 32-bit words, then the 
+ *  modulus, the base and every table entry as k limbs, all little endian. 
+ *  Nothing is written when buf is NULL or smaller than needed.
  *
- *  Input: base in large number format, exponent in 
- *         big number format, a big number pointer
- *  Output:
+ *  Input: a comb, destination buffer or NULL, its size in bytes
+ *  Output: number of bytes of the serialized comb
  * 
- *	Pseudocode:
- *			if expoent = 0: 
- *				return  1;
- *
- *			else if expoent = 1: 
- *				return base;
- *
- *			else if expoent is even: 
- *				return pow(base * base,  expoent / 2);
- *
- *			else if expoent is odd: 
- *				return base * pow(base * base, (expoent - 1) / 2);
- *
  */
-void pow_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *result){
-	BIGNUM *b = init_bn();
-	BIGNUM *e = init_bn();
-
-	copy_bn(b, bb);
-	copy_bn(e, ee);
-
-	BIGNUM *zero = int_to_bn(0);
-	BIGNUM *one  = int_to_bn(1);
-	BIGNUM *two  = int_to_bn(2);
-	
-	BIGNUM *mod = init_bn();
-	mod_bn(e, two, mod);
-
-	if(comp_bn(e, zero) == 0){
-		
-		copy_bn(result, one);
-	
-	}else if(comp_bn(e, one) == 0){
-
-		copy_bn(result, b);
-	
-	}else if(comp_bn(mod, zero) == 0){
-		
-		BIGNUM *div = init_bn();
-		div_bn(e, two, div);
-		
-		BIGNUM *mul = init_bn();
-		mul_bn(b, b, mul);
-
-		pow_bn(mul, div, result);
-
-		free_bn(div);
-		free_bn(mul);
+size_t serialize_comb_bn(BN_COMB *comb, uint8_t *buf, size_t size){
+	int k = comb->m->size;
+	int entries = 1 << comb->teeth;
+	size_t needed = 16 + (size_t)(entries + 2) * k * 8;
 
-	}else {
-		
-		BIGNUM *sub = init_bn();
-		sub_bn(e, one, sub);
+	if(buf == NULL || size < needed){
+		return needed;
+	}
 
-		BIGNUM *div = init_bn();
-		div_bn(sub, two, div);
+	memcpy(buf, "BNCB", 4);
 
-		BIGNUM *mul = init_bn();
-		mul_bn(b, b, mul);
+	uint32_t header[3] = { (uint32_t)comb->teeth, (uint32_t)comb->spacing, (uint32_t)k };
+	for(int i = 0; i < 3; i++){
+		for(int j = 0; j < 4; j++){
+			buf[4 + 4 * i + j] = (uint8_t)(header[i] >> (8 * j));
+		}
+	}
 
-		BIGNUM *pow = init_bn();
-		pow_bn(mul, div, pow);
+	uint8_t *w = buf + 16;
 
-		mul_bn(b, pow, result);
+	for(int v = -2; v < entries; v++){
+		BIGNUM *x = v == -2 ? comb->m : v == -1 ? comb->g : comb->table[v];
 
-		free_bn(sub);
-		free_bn(div);
-		free_bn(mul);
-		free_bn(pow);
+		for(int i = 0; i < k; i++, w += 8){
+			put_word(w, i < x->size ? x->digits[i] : 0);
+		}
 	}
 
-	free_bn(b);
-	free_bn(e);
-	free_bn(zero);
-	free_bn(one);
-	free_bn(two);
-	free_bn(mod);
+	return needed;
 }
 
-/*  Calculates the exponentiation of a big number
- *
- *  Input: base in large number format, exponent in 
- *         big number format, a big number pointer
- *  Output:
+/*  Loads a comb written by serialize_comb_bn, rebuilding only the 
+ *  reducer of the modulus. The base and the table entries must be below 
+ *  the modulus, as the reducer expects.
  *
- *	Pseudocode: 
- *		 	result = 1    
- *
- * 			base %= m 
- *			      
- *			if (base == 0): 
- *			    return 0
- * 			  
- *			while (expoent > 0): 
- *			    if ((expoent & 1) == 1): 
- *			    	result = (result * base) % module
- *			      
- *			    expoent /= 2  
- *			    base = (base * base) % module
- *			          
- *			return result
+ *  Input: source buffer, its size in bytes
+ *  Output: pointer to the comb, or NULL if the buffer does not hold one
  * 
  */
-void pow_mod_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *mm, BIGNUM *result){
-	BIGNUM *b = init_bn();
-	BIGNUM *e = init_bn();
-	BIGNUM *m = init_bn();
-
-	copy_bn(b, bb);
-	copy_bn(e, ee);
-	copy_bn(m, mm);
-
-	BIGNUM *r = int_to_bn(1);
-
-	BIGNUM *zero = int_to_bn(0);
-	BIGNUM *one  = int_to_bn(1);
-	BIGNUM *two  = int_to_bn(2);
-
-	BIGNUM *mod = init_bn();
-	mod_bn(b, m, mod);
-	copy_bn(b, mod);
-	free_bn(mod);
-
-	while(comp_bn(e, zero) == 1){
-		if(e->digits[e->size - 1] & 1 == 1){
-			
-			BIGNUM *mul = init_bn(); 
-			mul_bn(r, b, mul);
-			
-			BIGNUM *mod = init_bn();
-			mod_bn(mul, m, mod);
-			copy_bn(r, mod);
-
-			free_bn(mul);
-			free_bn(mod);
-			
-		}
-		
-		BIGNUM *div = init_bn();
-		div_bn(e, two, div);
-		copy_bn(e, div);
-		
-		BIGNUM *mul = init_bn();
-		mul_bn(b, b, mul);
-
-		BIGNUM *mod = init_bn();
-		mod_bn(mul, m, mod);
-	    copy_bn(b, mod);
-
-		free_bn(div);
-		free_bn(mul);
-		free_bn(mod);
-	}
-	
-	free_bn(b);
-	free_bn(e);
-	free_bn(m);
-	free_bn(zero);
-	free_bn(one);
-	free_bn(two);
-	
-	copy_bn(result, r);
+BN_COMB* deserialize_comb_bn(const uint8_t *buf, size_t size){
+	if(size < 16 || memcmp(buf, "BNCB", 4) != 0){
+		return NULL;
+	}
+
+	uint32_t header[3];
+	for(int i = 0; i < 3; i++){
+		header[i] = 0;
+		for(int j = 0; j < 4; j++){
+			header[i] |= (uint32_t)buf[4 + 4 * i + j] << (8 * j);
+		}
+	}
+
+	int teeth   = (int)header[0];
+	int spacing = (int)header[1];
+	int k       = (int)header[2];
+
+	if(teeth < 1 || teeth > 16 || spacing < 1 || k < 1 || header[2] > (1u << 26)){
+		return NULL;
+	}
+
+	/* the bits covered by the comb must fit the int exponent lengths */
+	if((int64_t)teeth * spacing > INT_MAX){
+		return NULL;
+	}
 
-	free_bn(r);
+	size_t needed = 16 + (size_t)((1 << teeth) + 2) * k * 8;
+	/* the modulus is stored first and its top limb is not zero */
+	if(size != needed || get_word(buf + 16 + (size_t)(k - 1) * 8) == 0){
+		return NULL;
+	}
+
+	const uint8_t *w = buf + 16;
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *m = get_ctx_bn(ctx);
+	resize_bn(m, k);
+	m->sign = 1;
+	for(int i = 0; i < k; i++, w += 8){
+		m->digits[i] = get_word(w);
+	}
+
+	BN_COMB *comb = alloc_comb_bn(m, teeth, spacing);
+
+	leave_ctx_bn(ctx);
+
+	for(int v = -1; v < 1 << teeth; v++){
+		BIGNUM *x = v == -1 ? comb->g : comb->table[v];
+
+		resize_bn(x, k);
+		x->sign = 1;
+		for(int i = 0; i < k; i++, w += 8){
+			x->digits[i] = get_word(w);
+		}
+		rmzero_bn(x);
+
+		if(comp_limbs(x->digits, x->size, comb->m->digits, comb->m->size) != -1){
+			free_comb_bn(comb);
+			return NULL;
+		}
+	}
+
+	return comb;
 }
 
-/*  calculates the greatest common divisor between two big numbers 
- *	with the euclidean algorithm
+/*  Calculates the greatest common divisor between two big numbers. 
+ *  The common power of two is taken out first, then Lehmer's method 
+ *  replaces batches of Euclidean steps by a 2x2 cofactor matrix applied 
+ *  to the full operands, and the binary method finishes once they fall 
+ *  below GCD_LEHMER_THRESHOLD limbs. The result is nonnegative.
  *
- *  Input: two big number pointers to calculate the mdc between 
+ *  Input: two big number pointers to calculate the mdc between
  *         them, a big number pointer
  *  Output:
- *
- *	Pseudocode:  
- * 				while (y != 0)
- *	       			r = x % y
- *	       			x = y
- *	       			y = r
- *				return x;
  * 
  */
 void mdc_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result){
-	BIGNUM *zero = int_to_bn(0);
-	BIGNUM *x = init_bn();
-	BIGNUM *y = init_bn();
+	if(xx->size == 0 || yy->size == 0){
+		copy_bn(result, xx->size == 0 ? yy : xx);
+		result->sign = 1;
+		return;
+	}
+
+	BN_CTX *ctx = enter_ctx_bn();
+
+	BIGNUM *x = get_ctx_bn(ctx);
+	BIGNUM *y = get_ctx_bn(ctx);
+	BIGNUM *t = get_ctx_bn(ctx);
+	BIGNUM *u = get_ctx_bn(ctx);
 
 	copy_bn(x, xx);
 	copy_bn(y, yy);
+	x->sign = 1;
+	y->sign = 1;
+
+	/* mdc(2^i a, 2^j b) = 2^min(i, j) mdc(a, b) for odd a and b */
+	int zx = ctz_bn(x), zy = ctz_bn(y);
+	int k = zx < zy ? zx : zy;
+
+	rshift_bn(x, zx, x);
+	rshift_bn(y, zy, y);
+
+	if(comp_bn(x, y) < 0){
+		swap_bn(x, y);
+	}
+
+	while(y->size >= GCD_LEHMER_THRESHOLD){
+		int n = x->size;
+		int64_t m[4];
 
-	while(comp_bn(y, zero) != 0){
+		lehmer_word(x->digits, n, y->digits, y->size, m);
 
-		BIGNUM *r = init_bn();
-		mod_bn(x, y, r);
+		if(m[1] == 0){
+			/* the leading bits gave no certain quotient, one full step */
+			divmod_bn(x, y, NULL, x);
+			swap_bn(x, y);
+			continue;
+		}
+
+		reserve_bn(y, n);
+		memset(y->digits + y->size, 0, (n - y->size) * sizeof(uint64_t));
 
-		copy_bn(x, y);
-		copy_bn(y, r);
+		resize_bn(t, n);
+		resize_bn(u, n);
+		lincomb_limbs(t->digits, x->digits, y->digits, n, m[0], m[1]);
+		lincomb_limbs(u->digits, x->digits, y->digits, n, m[2], m[3]);
+		t->sign = 1;
+		u->sign = 1;
+		rmzero_bn(t);
+		rmzero_bn(u);
 
-		free_bn(r);
+		swap_bn(x, t);
+		swap_bn(y, u);
 	}
 
-	copy_bn(result, x);
-	free_bn(zero);
-	free_bn(x);
-	free_bn(y);
+	if(y->size != 0 && x->size > y->size){
+		divmod_bn(x, y, NULL, x);
+		swap_bn(x, y);
+	}
+
+	if(y->size != 0){
+		x->size = strip_zeros_limbs(x->digits, x->size);
+		y->size = strip_zeros_limbs(y->digits, y->size);
+		x->size = gcd_binary_limbs(x->digits, x->size, y->digits, y->size);
+	}
+
+	/* restores the common power of two */
+	lshift_bn(x, k, result);
+
+	leave_ctx_bn(ctx);
 }
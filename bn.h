@@ -1,14 +1,108 @@
 #ifndef BN_H_INCLUDED
 #define BN_H_INCLUDED
 
+/*	Limbs stored inside BIGNUM itself, so that numbers of up to that 
+ *	many limbs keep their digits off the heap
+ */
+#ifndef BN_INLINE_LIMBS
+#define BN_INLINE_LIMBS 2
+#endif
+
+/*	The magnitude is kept in digits as 64-bit limbs, least significant 
+ *	limb first, with size counting the limbs in use and capacity the 
+ *	limbs allocated. Zero has no limbs. sign is 1 for positive numbers 
+ *	and 0 for negative ones. digits starts out pointing to the inline 
+ *	limbs in small and moves to the heap when the number outgrows them. 
+ *	borrowed marks limbs owned by someone else, such as a mapped file, 
+ *	which are copied before being written.
+ */
 typedef struct {
 
-	uint8_t *digits;
+	uint64_t *digits;
 	uint8_t sign;
+	uint8_t borrowed;
 	int size;
+	int capacity;
+	uint64_t small[BN_INLINE_LIMBS];
 	
 }BIGNUM;
 
+/*	Declares an empty big number with automatic storage, usable wherever 
+ *	one from init_bn is. It must be released with clear_bn instead of 
+ *	free_bn, which is needed only if it outgrew its inline limbs. 
+ *	Arithmetic on such word-sized numbers does not touch the heap.
+ */
+#define BN_STACK(name) BIGNUM name = { .digits = name.small, .sign = 1, .capacity = BN_INLINE_LIMBS }
+
+/*	Scratch space for the temporaries of the operations. Numbers handed 
+ *	out by get_ctx_bn keep their limbs when their frame is closed, so a 
+ *	context that is reused stops touching the heap once it is warm.
+ */
+typedef struct {
+
+	BIGNUM **pool;
+	int used;
+	int count;
+	int *frames;
+	int depth;
+	int frames_capacity;
+
+}BN_CTX;
+
+/*	Montgomery context of an odd modulus: the modulus, R^2 mod n and 
+ *	-n^-1 mod 2^64, where R is 2^64 to the number of limbs of n
+ */
+typedef struct {
+
+	BIGNUM *n;
+	BIGNUM *rr;
+	uint64_t ninv;
+
+}BN_MONT;
+
+/*	Barrett context of a modulus of k limbs: the modulus and 
+ *	floor(2^(128k) / m)
+ */
+typedef struct {
+
+	BIGNUM *m;
+	BIGNUM *mu;
+
+}BN_BARRETT;
+
+/*	CRT context of a modulus p q with known prime factors: the factors, 
+ *	the CRT exponents, q^-1 mod p and a Montgomery context for each 
+ *	factor. parallel selects two threads when built with BN_THREADS.
+ */
+typedef struct {
+
+	BIGNUM *p;
+	BIGNUM *q;
+	BIGNUM *dp;
+	BIGNUM *dq;
+	BIGNUM *qinv;
+	BN_MONT *mont_p;
+	BN_MONT *mont_q;
+	int parallel;
+
+}BN_CRT;
+
+/*	Lim-Lee comb of a fixed base and modulus: 2^teeth precomputed 
+ *	products of the powers g^(2^(i spacing)) in the form of the reducer 
+ *	of the modulus
+ */
+typedef struct {
+
+	BIGNUM *g;
+	BIGNUM *m;
+	BN_MONT *mont;
+	BN_BARRETT *barrett;
+	BIGNUM **table;
+	int teeth;
+	int spacing;
+
+}BN_COMB;
+
 /*	Initializes the number values ​​and returns a big number pointer	
  *
  *  Input:
@@ -17,7 +111,8 @@ typedef struct {
  */
 BIGNUM* init_bn();
 
-/*	Converts a big number to an integer	
+/*	Converts a big number to an integer, keeping only the low bits of 
+ *	numbers out of range
  *
  *  Input: a big number pointer
  *  Output: an integer
@@ -33,6 +128,57 @@ int bn_to_int(BIGNUM *num);
  */
 BIGNUM* int_to_bn(int num);
 
+/*	Converts a signed 64-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* int64_to_bn(int64_t num);
+
+/*	Converts an unsigned 64-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* uint64_to_bn(uint64_t num);
+
+/*	Converts a signed 128-bit integer to a big number
+ *
+ *  Input: the integer
+ *  Output: a big number pointer
+ * 
+ */
+BIGNUM* int128_to_bn(__int128 num);
+
+/*	Converts a big number to a signed 64-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is out of range
+ * 
+ */
+int bn_to_int64(BIGNUM *num, int64_t *value);
+
+/*	Converts a big number to an unsigned 64-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is negative or too large
+ * 
+ */
+int bn_to_uint64(BIGNUM *num, uint64_t *value);
+
+/*	Converts a big number to a signed 128-bit integer
+ *
+ *  Input: a big number pointer, pointer for the integer, written only 
+ *         when the number fits
+ *  Output: 0 on success, -1 if the number is out of range
+ * 
+ */
+int bn_to_int128(BIGNUM *num, __int128 *value);
+
 /*	Converts a string-like integer to a big number 
  *
  *  Input: a string
@@ -41,6 +187,103 @@ BIGNUM* int_to_bn(int num);
  */
 BIGNUM* str_to_bn(char num[], int size);
 
+/*	Upper bound of the length of the decimal string of a big number, 
+ *	counting the sign and the terminating null
+ *
+ *  Input: a big number pointer
+ *  Output: the buffer size that bn_to_str always fits in
+ * 
+ */
+size_t str_size_bn(BIGNUM *num);
+
+/*	Converts a big number to a decimal string, with a leading '-' for 
+ *	negative numbers, written directly into buf when it fits; str_size_bn 
+ *	bytes always do. A NULL buf gets a newly allocated string to be 
+ *	released with free.
+ *
+ *  Input: a big number pointer, a buffer or NULL, size of the buffer
+ *  Output: the string, or NULL if it does not fit in buf
+ * 
+ */
+char* bn_to_str(BIGNUM *num, char *buf, size_t size);
+
+/*	Writes the decimal string of a big number to a stream
+ *
+ *  Input: a big number pointer, an output stream
+ *  Output: the number of characters written, -1 on error
+ * 
+ */
+int bn_write(BIGNUM *num, FILE *stream);
+
+/*	Writes the decimal string of a big number to a file descriptor
+ *
+ *  Input: a big number pointer, a file descriptor
+ *  Output: the number of characters written, -1 on error
+ * 
+ */
+int bn_write_fd(BIGNUM *num, int fd);
+
+/*	Exports the magnitude of a big number as bytes in the given order. 
+ *	Nothing is written when buf is NULL or smaller than needed.
+ *
+ *  Input: a big number pointer, destination buffer or NULL, its size in 
+ *         bytes, nonzero for most significant byte first
+ *  Output: number of bytes of the magnitude
+ * 
+ */
+size_t export_bn(BIGNUM *x, uint8_t *buf, size_t size, int big_endian);
+
+/*	Imports a nonnegative big number from bytes in the given order
+ *
+ *  Input: source buffer, its size in bytes, nonzero for most significant 
+ *         byte first, a big number pointer
+ *  Output:
+ * 
+ */
+void import_bn(const uint8_t *buf, size_t size, int big_endian, BIGNUM *result);
+
+/*	Serializes many big numbers into a versioned binary container with 
+ *	a header of sizes and signs followed by the limbs. Nothing is written 
+ *	when buf is NULL or smaller than needed.
+ *
+ *  Input: array of big numbers, its size, destination buffer or NULL, 
+ *         its size in bytes
+ *  Output: number of bytes of the container
+ * 
+ */
+size_t serialize_bn(BIGNUM **nums, int count, uint8_t *buf, size_t size);
+
+/*	Writes the binary container of serialize_bn to a file descriptor
+ *
+ *  Input: array of big numbers, its size, a file descriptor
+ *  Output: 0 on success, -1 on error
+ * 
+ */
+int serialize_fd_bn(BIGNUM **nums, int count, int fd);
+
+/*	Loads the big numbers of a binary container into count big numbers, 
+ *	copying their limbs. A NULL array only counts them.
+ *
+ *  Input: the container, its size in bytes, array of big number 
+ *         pointers or NULL, its size
+ *  Output: the number of big numbers in the container, -1 if it is 
+ *          malformed
+ * 
+ */
+int deserialize_bn(const uint8_t *buf, size_t size, BIGNUM **nums, int count);
+
+/*	Wraps the big numbers of a binary container, such as a mapped file, 
+ *	without copying their limbs. buf must outlive the numbers, which are 
+ *	read only until they are used as a result.
+ *
+ *  Input: the container, its size in bytes, array of big number 
+ *         pointers or NULL, its size
+ *  Output: the number of big numbers in the container, -1 if it is 
+ *          malformed
+ * 
+ */
+int map_bn(const uint8_t *buf, size_t size, BIGNUM **nums, int count);
+
 /*	Calculates the bit size of a large number
  *
  *  Input: a big number
@@ -49,6 +292,94 @@ BIGNUM* str_to_bn(char num[], int size);
  */
 int bit_length_bn(BIGNUM *num);
 
+/*  Shifts a big number left, multiplying it by 2^bits
+ *
+ *  Input: a big number pointer, the shift in bits, a big number pointer
+ *  Output:
+ * 
+ */
+void lshift_bn(BIGNUM *x, int bits, BIGNUM *result);
+
+/*  Shifts the magnitude of a big number right, truncating toward zero
+ *
+ *  Input: a big number pointer, the shift in bits, a big number pointer
+ *  Output:
+ * 
+ */
+void rshift_bn(BIGNUM *x, int bits, BIGNUM *result);
+
+/*  Bitwise and of two big numbers in infinite two's complement
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void and_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result);
+
+/*  Bitwise or of two big numbers in infinite two's complement
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void or_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result);
+
+/*  Bitwise exclusive or of two big numbers in infinite two's complement
+ *
+ *  Input: two big numbers pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void xor_bn(BIGNUM *x, BIGNUM *y, BIGNUM *result);
+
+/*  Bitwise not of a big number in infinite two's complement, -x - 1
+ *
+ *  Input: a big number pointer, a big number pointer
+ *  Output:
+ * 
+ */
+void not_bn(BIGNUM *x, BIGNUM *result);
+
+/*  Tests a bit of the magnitude of a big number
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output: the bit, 0 or 1
+ * 
+ */
+int test_bit_bn(BIGNUM *x, int bit);
+
+/*  Sets a bit of the magnitude of a big number
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output:
+ * 
+ */
+void set_bit_bn(BIGNUM *x, int bit);
+
+/*  Clears a bit of the magnitude of a big number
+ *
+ *  Input: a big number pointer, the bit index
+ *  Output:
+ * 
+ */
+void clear_bit_bn(BIGNUM *x, int bit);
+
+/*  Counts the set bits of the magnitude of a big number
+ *
+ *  Input: a big number pointer
+ *  Output: the number of set bits
+ * 
+ */
+int popcount_bn(BIGNUM *x);
+
+/*  Counts the trailing zero bits of a big number
+ *
+ *  Input: a big number pointer
+ *  Output: the index of the lowest set bit, -1 for zero
+ * 
+ */
+int ctz_bn(BIGNUM *x);
+
 /*	Copy a big number to another big number
  *
  *  Input: two big numbers pointer
@@ -58,7 +389,7 @@ int bit_length_bn(BIGNUM *num);
 void copy_bn(BIGNUM *a, BIGNUM *b);
 
 /*	Copy a big number to another big number and 
- *	invert the order of the digits 
+ *	invert the order of the limbs 
  *
  *  Input: two big numbers pointer
  *  Output:
@@ -66,7 +397,7 @@ void copy_bn(BIGNUM *a, BIGNUM *b);
  */
 void copy_rev_bn(BIGNUM *a, BIGNUM *b);
 
-/*	Reverse the order of the digits of the large number
+/*	Reverse the order of the limbs of the large number
  *
  *  Input: a big number pointer
  *  Output:
@@ -74,7 +405,7 @@ void copy_rev_bn(BIGNUM *a, BIGNUM *b);
  */
 void rev_bn(BIGNUM *num);
 
-/*	Removes zeros to the left of the large number
+/*	Removes zero limbs to the left of the large number
  *
  *  Input: a big number pointer
  *  Output:
@@ -82,7 +413,7 @@ void rev_bn(BIGNUM *num);
  */
 void rmzero_bn(BIGNUM *num);
 
-/*  Compares two large numbers
+/*  Compares the magnitude of two large numbers
  *
  *  Input: two big numbers pointer
  *  Output:
@@ -109,6 +440,85 @@ int max(int x, int y);
  */
 void free_bn(BIGNUM *x);
 
+/*  Releases the limbs of a big number declared with BN_STACK, leaving it 
+ *  empty and reusable
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void clear_bn(BIGNUM *x);
+
+/*  Makes room for at least the specified number of limbs. The buffer 
+ *  grows geometrically so repeated growth costs amortized constant time.
+ *
+ *  Input: a big number pointer, number of limbs
+ *  Output:
+ * 
+ */
+void reserve_bn(BIGNUM *x, int n);
+
+/*  Releases the unused limbs of a big number
+ *
+ *  Input: a big number pointer
+ *  Output:
+ * 
+ */
+void shrink_bn(BIGNUM *x);
+
+/*  Initializes an empty scratch context
+ *
+ *  Input:
+ *  Output: a context pointer
+ * 
+ */
+BN_CTX* init_ctx_bn();
+
+/*  Free a context and every scratch number it owns
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void free_ctx_bn(BN_CTX *ctx);
+
+/*  Binds a context to the calling thread. Every operation run by the 
+ *  thread afterwards takes its temporaries from it. NULL unbinds it, 
+ *  returning the thread to its default context, which is created on 
+ *  first use and freed when the thread exits.
+ *
+ *  Input: a context pointer or NULL
+ *  Output: the context previously bound
+ * 
+ */
+BN_CTX* set_ctx_bn(BN_CTX *ctx);
+
+/*  Opens a frame on the context, numbers obtained afterwards are 
+ *  released together by the matching end_ctx_bn
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void start_ctx_bn(BN_CTX *ctx);
+
+/*  Takes a scratch number from the current frame of the context. The 
+ *  number starts as zero and keeps the limbs of its previous uses.
+ *
+ *  Input: a context pointer
+ *  Output: a big number pointer valid until the frame is closed
+ * 
+ */
+BIGNUM* get_ctx_bn(BN_CTX *ctx);
+
+/*  Closes the current frame of the context
+ *
+ *  Input: a context pointer
+ *  Output:
+ * 
+ */
+void end_ctx_bn(BN_CTX *ctx);
+
 /*  Prints a big number
  *
  *  Input: a big number pointer
@@ -125,10 +535,10 @@ void print_bn(BIGNUM *num);
  */
 void println_bn(BIGNUM *num);
 
-/*  Generates a large random number between 0 and the specified value,
- *	[0, maximum value[.
+/*  Generates a large random number with up to the specified number of
+ *  limbs, [0, 2^(64 * maximum size)[.
  *
- *  Input: maximum value, a big number pointer
+ *  Input: maximum size in limbs, a big number pointer
  *  Output:
  * 
  */
@@ -160,7 +570,7 @@ void sum_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void sub_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
-/*  Add zeros to the left to make the large number the specified size
+/*  Add zero limbs to the left to make the large number the specified size
  *
  *  Input: a big number pointer, integer number specifying the size that the big number will be
  *  Output:
@@ -168,7 +578,8 @@ void sub_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void fill(BIGNUM *x, int n);
 
-/*  Split a big number between two positions
+/*  Split a big number between two limb positions, counted from the least
+ *  significant limb
  *
  *  Input: a big number pointer, integer containing the starting position value, 
  *	       integer containing the final position value, a big number pointer
@@ -185,7 +596,8 @@ void split(BIGNUM *x, int start, int end, BIGNUM *result);
  */
 void fastpow_base10_bn(BIGNUM *e, BIGNUM *result);
 
-/*  Performs a multiplication of big numbers using the karatsuba algorithm
+/*  Performs a multiplication of big numbers using the karatsuba algorithm,
+ *  mul_bn already switches to it for large operands
  *
  *  Input: two big numbers that will be multiplied, a big number pointer
  *  Output:
@@ -193,7 +605,10 @@ void fastpow_base10_bn(BIGNUM *e, BIGNUM *result);
  */
 void karatsuba(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
-/*  Multiplies two big numbers
+/*  Multiplies two big numbers. Scratch space is taken from the context 
+ *  only by the Karatsuba and larger methods or when the result is one of 
+ *  the operands and outgrows the inline limbs, so small products do not 
+ *  allocate.
  *
  *  Input: two big numbers that will be multiplied, a big number pointer
  *  Output:
@@ -201,6 +616,29 @@ void karatsuba(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void mul_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
+/*  Squares a big number, cheaper than mul_bn with two different 
+ *  operands since each cross product is computed once. mul_bn calls it 
+ *  when both operands are the same big number. Like mul_bn it does not 
+ *  allocate for small operands.
+ *
+ *  Input: the big number to be squared, a big number pointer
+ *  Output:
+ * 
+ */
+void sqr_bn(BIGNUM *x, BIGNUM *result);
+
+/*  Divides two big numbers computing the quotient and the remainder in 
+ *  a single pass. The quotient is truncated and the remainder has the 
+ *  sign of the dividend, either output may be NULL.
+ *
+ *  Input: dividend in big number format, divisor in big number 
+ *         format, a big number pointer for the quotient, a big number 
+ *         pointer for the remainder
+ *  Output:
+ * 
+ */
+void divmod_bn(BIGNUM *x, BIGNUM *y, BIGNUM *quotient, BIGNUM *remainder);
+
 /*  Divides two big numbers
  *
  *  Input: dividend in big number format, divisor in big number 
@@ -219,7 +657,60 @@ void div_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void mod_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
-/*  Calculates the inverse multiplicative module of two big numbers
+/*  Adds a machine word to a big number
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void add_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result);
+
+/*  Subtracts a machine word from a big number
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void sub_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result);
+
+/*  Multiplies a big number by a machine word
+ *
+ *  Input: a big number pointer, the word, a big number pointer
+ *  Output:
+ * 
+ */
+void mul_ui_bn(BIGNUM *x, uint64_t y, BIGNUM *result);
+
+/*  Divides a big number by a nonzero machine word, truncating toward 
+ *  zero. The quotient may be NULL.
+ *
+ *  Input: dividend in big number format, the divisor, a big number 
+ *         pointer or NULL
+ *  Output: the remainder of the magnitude of x
+ * 
+ */
+uint64_t divmod_ui_bn(BIGNUM *x, uint64_t d, BIGNUM *quotient);
+
+/*  Calculates the remainder of the magnitude of a big number by a 
+ *  nonzero machine word
+ *
+ *  Input: dividend in big number format, the divisor
+ *  Output: the remainder
+ * 
+ */
+uint64_t mod_ui_bn(BIGNUM *x, uint64_t d);
+
+/*  Raises a big number to a machine word exponent
+ *
+ *  Input: base in big number format, the exponent, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_ui_bn(BIGNUM *x, uint64_t e, BIGNUM *result);
+
+/*  Calculates the inverse multiplicative module of two big numbers 
+ *  with the extended Lehmer algorithm. The result is in [0, m), or 0 
+ *  when x has no inverse.
  *
  *  Input: dividend in big number format, divisor in big number 
  *         format, a big number pointer
@@ -228,6 +719,17 @@ void mod_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void mod_inverse_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
+/*  Inverts n big numbers modulo the same m with a single inversion and 
+ *  3(n - 1) modular multiplications. Every result is 0 when any of the 
+ *  numbers has no inverse. The results may alias the inputs.
+ *
+ *  Input: array of big numbers to invert, its size, modulus in big 
+ *         number format, array of n big number pointers for the results
+ *  Output:
+ * 
+ */
+void batch_inverse_bn(BIGNUM **x, int n, BIGNUM *m, BIGNUM **result);
+
 /*  Calculates the exponentiation of a big number
  *
  *  Input: base in large number format, exponent in 
@@ -237,17 +739,20 @@ void mod_inverse_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
  */
 void pow_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *result);
 
-/*  Calculates the exponentiation of a big number
+/*  Calculates the modular exponentiation of a big number, with 
+ *  Montgomery multiplication for odd moduli. The result is in [0, m).
  *
  *  Input: base in large number format, exponent in 
- *         big number format, a big number pointer
+ *         big number format, modulus in big number format, a big 
+ *         number pointer
  *  Output:
  * 
  */
 void pow_mod_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *mm, BIGNUM *result);
 
 /*  Calculates the greatest common divisor between two large 
- *  numbers
+ *  numbers with Lehmer's method, finishing with the binary method on 
+ *  small operands. The result is nonnegative.
  *
  *  Input: two big number pointers to calculate the mdc between 
  *         them, a big number pointer
@@ -256,4 +761,188 @@ void pow_mod_bn(BIGNUM *bb, BIGNUM *ee, BIGNUM *mm, BIGNUM *result);
  */
 void mdc_bn(BIGNUM *xx, BIGNUM *yy, BIGNUM *result);
 
+/*  Creates a Montgomery context for an odd modulus, which can be reused 
+ *  by any number of operations under that modulus
+ *
+ *  Input: odd modulus in big number format
+ *  Output: pointer to the Montgomery context
+ * 
+ */
+BN_MONT* init_mont_bn(BIGNUM *m);
+
+/*  Frees a Montgomery context
+ *
+ *  Input: a Montgomery context pointer
+ *  Output:
+ * 
+ */
+void free_mont_bn(BN_MONT *mont);
+
+/*  Converts a big number to Montgomery form, x * R mod m
+ *
+ *  Input: a big number pointer, a Montgomery context, a big number pointer
+ *  Output:
+ * 
+ */
+void to_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result);
+
+/*  Converts a big number out of Montgomery form, x * R^-1 mod m
+ *
+ *  Input: a big number in Montgomery form, a Montgomery context, a big 
+ *         number pointer
+ *  Output:
+ * 
+ */
+void from_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result);
+
+/*  Multiplies two big numbers in Montgomery form, x * y * R^-1 mod m
+ *
+ *  Input: two big numbers in Montgomery form below m, a Montgomery 
+ *         context, a big number pointer
+ *  Output:
+ * 
+ */
+void mul_mont_bn(BIGNUM *x, BIGNUM *y, BN_MONT *mont, BIGNUM *result);
+
+/*  Squares a big number in Montgomery form, x * x * R^-1 mod m
+ *
+ *  Input: a big number in Montgomery form below m, a Montgomery context, 
+ *         a big number pointer
+ *  Output:
+ * 
+ */
+void sqr_mont_bn(BIGNUM *x, BN_MONT *mont, BIGNUM *result);
+
+/*  Calculates the modular exponentiation of a big number under the 
+ *  modulus of a Montgomery context, pow_mod_bn uses it for odd moduli. 
+ *  The result is in [0, m).
+ *
+ *  Input: base in big number format, exponent in big number format, a 
+ *         Montgomery context, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_mod_mont_bn(BIGNUM *bb, BIGNUM *ee, BN_MONT *mont, BIGNUM *result);
+
+/*  Creates a Barrett context for any modulus, which can be reused by any 
+ *  number of reductions modulo it
+ *
+ *  Input: modulus in big number format
+ *  Output: pointer to the Barrett context
+ * 
+ */
+BN_BARRETT* init_barrett_bn(BIGNUM *m);
+
+/*  Frees a Barrett context
+ *
+ *  Input: a Barrett context pointer
+ *  Output:
+ * 
+ */
+void free_barrett_bn(BN_BARRETT *barrett);
+
+/*  Reduces a big number modulo the modulus of a Barrett context, with 
+ *  the same result as mod_bn but two multiplications instead of a 
+ *  division for numbers below the square of the modulus
+ *
+ *  Input: a big number pointer, a Barrett context, a big number pointer
+ *  Output:
+ * 
+ */
+void mod_barrett_bn(BIGNUM *x, BN_BARRETT *barrett, BIGNUM *result);
+
+/*  Calculates the modular exponentiation of a big number under the 
+ *  modulus of a Barrett context, pow_mod_bn uses it for even moduli. The 
+ *  result is in [0, m).
+ *
+ *  Input: base in big number format, exponent in big number format, a 
+ *         Barrett context, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_mod_barrett_bn(BIGNUM *bb, BIGNUM *ee, BN_BARRETT *barrett, BIGNUM *result);
+
+/*  Calculates the product of bases[i]^exps[i] mod m over k bases in a 
+ *  single pass that shares the squarings among all bases, so that 
+ *  a^x * b^y mod m costs little more than one exponentiation. The result 
+ *  is in [0, m).
+ *
+ *  Input: array of bases, array of exponents, number of bases, modulus 
+ *         in big number format, a big number pointer
+ *  Output:
+ * 
+ */
+void multi_pow_mod_bn(BIGNUM **bases, BIGNUM **exps, int k, BIGNUM *m, BIGNUM *result);
+
+/*  Creates a CRT context from the odd prime factors p and q of a modulus 
+ *  and the CRT exponents dp = d mod (p - 1) and dq = d mod (q - 1)
+ *
+ *  Input: the prime factors p and q, the CRT exponents dp and dq
+ *  Output: pointer to the CRT context
+ * 
+ */
+BN_CRT* init_crt_bn(BIGNUM *p, BIGNUM *q, BIGNUM *dp, BIGNUM *dq);
+
+/*  Frees a CRT context
+ *
+ *  Input: a CRT context pointer
+ *  Output:
+ * 
+ */
+void free_crt_bn(BN_CRT *crt);
+
+/*  Calculates x^d mod p q with two half size exponentiations, run on two 
+ *  threads when built with BN_THREADS, recombined with Garner's formula. 
+ *  The result is in [0, p q).
+ *
+ *  Input: base in big number format, a CRT context, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_crt_bn(BIGNUM *x, BN_CRT *crt, BIGNUM *result);
+
+/*  Precomputes a comb table for a fixed base and modulus, serving any 
+ *  exponent of up to the given length with far fewer squarings than 
+ *  pow_mod_bn
+ *
+ *  Input: base in big number format, modulus in big number format, 
+ *         largest exponent length in bits
+ *  Output: pointer to the comb
+ * 
+ */
+BN_COMB* init_comb_bn(BIGNUM *g, BIGNUM *m, int bits);
+
+/*  Frees a comb
+ *
+ *  Input: a comb pointer
+ *  Output:
+ * 
+ */
+void free_comb_bn(BN_COMB *comb);
+
+/*  Calculates g^e mod m with the comb of g and m, the result is in [0, m)
+ *
+ *  Input: exponent in big number format, a comb, a big number pointer
+ *  Output:
+ * 
+ */
+void pow_comb_bn(BIGNUM *e, BN_COMB *comb, BIGNUM *result);
+
+/*  Serializes a comb into a buffer, writing nothing when buf is NULL or 
+ *  too small
+ *
+ *  Input: a comb, destination buffer or NULL, its size in bytes
+ *  Output: number of bytes of the serialized comb
+ * 
+ */
+size_t serialize_comb_bn(BN_COMB *comb, uint8_t *buf, size_t size);
+
+/*  Loads a comb written by serialize_comb_bn
+ *
+ *  Input: source buffer, its size in bytes
+ *  Output: pointer to the comb, or NULL if the buffer does not hold one
+ * 
+ */
+BN_COMB* deserialize_comb_bn(const uint8_t *buf, size_t size);
+
 #endif